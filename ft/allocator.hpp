@@ -1,6 +1,12 @@
 #ifndef ALLOCATOR_HPP
 #define ALLOCATOR_HPP
 
+#include "type_traits.hpp"
+
+#include <cstring>
+#include <memory>
+#include <new>
+
 namespace ft {
 template <typename _T_ForwardIterator, typename _T_Allocator>
 void destroy_a(_T_ForwardIterator first, _T_ForwardIterator last,
@@ -41,6 +47,88 @@ uninitialized_copy_a(_T_InputIterator first, _T_InputIterator last,
     throw;
   }
 }
+
+/*
+  Copying between two arrays of scalars with the default allocator does not
+  need to go through construct, a single memmove does the job.
+*/
+template <typename _T_Value>
+_T_Value *_uninitialized_copy_a(_T_Value *first, _T_Value *last,
+                                _T_Value *result, std::allocator<_T_Value>,
+                                true_type) {
+  std::size_t const n = last - first;
+  if (n != 0) {
+    std::memmove(result, first, n * sizeof(_T_Value));
+  }
+  return result + n;
+}
+
+template <typename _T_Value>
+_T_Value *_uninitialized_copy_a(_T_Value *first, _T_Value *last,
+                                _T_Value *result,
+                                std::allocator<_T_Value> alloc, false_type) {
+  return uninitialized_copy_a<_T_Value *, _T_Value *,
+                              std::allocator<_T_Value> >(first, last, result,
+                                                         alloc);
+}
+
+template <typename _T_Value>
+_T_Value *uninitialized_copy_a(_T_Value *first, _T_Value *last,
+                               _T_Value *result,
+                               std::allocator<_T_Value> alloc) {
+  return _uninitialized_copy_a(first, last, result, alloc,
+                               typename is_scalar<_T_Value>::type());
+}
+
+/* -------------------------------------------------------------------------- */
+/*                              emplace arguments                             */
+/* -------------------------------------------------------------------------- */
+/*
+  Without variadic templates, the arguments of an emplace call are captured by
+  one of these functors which then builds the value in place, directly into the
+  final storage.
+*/
+struct emplace_args0 {
+  template <typename _T_Value> void operator()(_T_Value *p) const {
+    ::new (static_cast<void *>(p)) _T_Value();
+  }
+};
+
+template <typename _T_Arg1> struct emplace_args1 {
+  _T_Arg1 const &_m_arg1;
+
+  explicit emplace_args1(_T_Arg1 const &a1) : _m_arg1(a1) {}
+
+  template <typename _T_Value> void operator()(_T_Value *p) const {
+    ::new (static_cast<void *>(p)) _T_Value(_m_arg1);
+  }
+};
+
+template <typename _T_Arg1, typename _T_Arg2> struct emplace_args2 {
+  _T_Arg1 const &_m_arg1;
+  _T_Arg2 const &_m_arg2;
+
+  emplace_args2(_T_Arg1 const &a1, _T_Arg2 const &a2)
+      : _m_arg1(a1), _m_arg2(a2) {}
+
+  template <typename _T_Value> void operator()(_T_Value *p) const {
+    ::new (static_cast<void *>(p)) _T_Value(_m_arg1, _m_arg2);
+  }
+};
+
+template <typename _T_Arg1, typename _T_Arg2, typename _T_Arg3>
+struct emplace_args3 {
+  _T_Arg1 const &_m_arg1;
+  _T_Arg2 const &_m_arg2;
+  _T_Arg3 const &_m_arg3;
+
+  emplace_args3(_T_Arg1 const &a1, _T_Arg2 const &a2, _T_Arg3 const &a3)
+      : _m_arg1(a1), _m_arg2(a2), _m_arg3(a3) {}
+
+  template <typename _T_Value> void operator()(_T_Value *p) const {
+    ::new (static_cast<void *>(p)) _T_Value(_m_arg1, _m_arg2, _m_arg3);
+  }
+};
 } // namespace ft
 
 #endif
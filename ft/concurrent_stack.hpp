@@ -0,0 +1,220 @@
+#ifndef CONCURRENT_STACK_HPP
+#define CONCURRENT_STACK_HPP
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <stdint.h>
+
+namespace ft {
+/* -------------------------------------------------------------------------- */
+/*                              concurrent stack                              */
+/* -------------------------------------------------------------------------- */
+/*
+  Lock-free Treiber stack, push and try_pop may be called from any number of
+  threads at once. Everything else (construction, destruction, reserve) must
+  not race with other calls.
+
+  Nodes come from a pool of chunks that are only released by the destructor,
+  a popped node goes to a free list and is reused by the next push. Since node
+  memory is never handed back while the stack lives, a thread may read the
+  link of a node that was popped under its feet. ABA is prevented by keeping
+  node indices instead of pointers in the list heads: a 32 bit index and a 32
+  bit tag bumped by every successful update share one 64 bit word, so a stale
+  compare and swap fails even when the same node is back on top.
+
+  Relies on the GCC/Clang __atomic builtins, the C++98 library has no atomics.
+*/
+template <typename _T_Value, typename _T_Allocator = std::allocator<_T_Value> >
+class concurrent_stack {
+  /* -------------------------------- typedef ------------------------------- */
+  struct node {
+    uint32_t _m_next;
+    _T_Value _m_value;
+  };
+
+  typedef typename _T_Allocator::template rebind<node>::other _t_node_allocator;
+  typedef uint64_t _t_tagged;
+
+  enum {
+    _S_chunk_base = 64,
+    _S_max_chunks = 24 // 64 * (2^24 - 1) nodes
+  };
+
+  static uint32_t const _S_null = 0xffffffffu;
+
+public:
+  typedef _T_Value value_type;
+  typedef _T_Allocator allocator_type;
+  typedef typename allocator_type::reference reference;
+  typedef typename allocator_type::const_reference const_reference;
+  typedef typename allocator_type::size_type size_type;
+
+  /* ------------------------------ constructor ----------------------------- */
+  explicit concurrent_stack(allocator_type const &alloc = allocator_type())
+      : _m_allocator(alloc), _m_head(_make_tagged(_S_null, 0)),
+        _m_free(_make_tagged(_S_null, 0)), _m_allocated(0) {
+    for (int i = 0; i < _S_max_chunks; ++i) {
+      _m_chunks[i] = NULL;
+    }
+  }
+
+  /* ------------------------------ destructor ------------------------------ */
+  ~concurrent_stack() {
+    for (uint32_t i = _index(_m_head); i != _S_null;) {
+      node *n = _node(i);
+      i = n->_m_next;
+      _m_allocator.destroy(&n->_m_value);
+    }
+    // a failed chunk allocation may leave a hole in the table
+    for (int c = 0; c < _S_max_chunks; ++c) {
+      if (_m_chunks[c]) {
+        _t_node_allocator(_m_allocator)
+            .deallocate(_m_chunks[c], _chunk_size(c));
+      }
+    }
+  }
+
+  /* ------------------------------- capacity ------------------------------- */
+  // snapshot, may be outdated as soon as it returns
+  bool empty() const {
+    return _index(__atomic_load_n(&_m_head, __ATOMIC_ACQUIRE)) == _S_null;
+  }
+
+  // pool nodes handed out so far, in use or on the free list
+  size_type capacity() const {
+    return __atomic_load_n(&_m_allocated, __ATOMIC_RELAXED);
+  }
+
+  // grows the pool so the next pushes up to n elements do not allocate
+  void reserve(size_type n) {
+    while (capacity() < n) {
+      _release_node(_new_node());
+    }
+  }
+
+  /* ------------------------------- modifiers ------------------------------ */
+  void push(value_type const &x) {
+    uint32_t const i = _acquire_node();
+    node *n = _node(i);
+    try {
+      _m_allocator.construct(&n->_m_value, x);
+    } catch (...) {
+      _release_node(i);
+      throw;
+    }
+    _push(_m_head, i);
+  }
+
+  // false when the stack was empty
+  bool try_pop(value_type &out) {
+    uint32_t const i = _pop(_m_head);
+    if (i == _S_null) {
+      return false;
+    }
+    node *n = _node(i);
+    try {
+      out = n->_m_value;
+    } catch (...) {
+      _push(_m_head, i);
+      throw;
+    }
+    _m_allocator.destroy(&n->_m_value);
+    _release_node(i);
+    return true;
+  }
+
+  /* -------------------------------- private ------------------------------- */
+private:
+  allocator_type _m_allocator;
+  _t_tagged _m_head;
+  _t_tagged _m_free;
+  uint32_t _m_allocated;
+  node *_m_chunks[_S_max_chunks];
+
+  concurrent_stack(concurrent_stack const &);
+  concurrent_stack &operator=(concurrent_stack const &);
+
+  static _t_tagged _make_tagged(uint32_t index, uint32_t tag) {
+    return (_t_tagged(tag) << 32) | index;
+  }
+
+  static uint32_t _index(_t_tagged t) { return uint32_t(t); }
+
+  static uint32_t _tag(_t_tagged t) { return uint32_t(t >> 32); }
+
+  static std::size_t _chunk_size(int c) {
+    return std::size_t(_S_chunk_base) << c;
+  }
+
+  // chunk c holds the indices [base * (2^c - 1), base * (2^(c + 1) - 1))
+  static int _chunk_of(uint32_t i) {
+    return 31 - __builtin_clz(i / _S_chunk_base + 1);
+  }
+
+  node *_node(uint32_t i) const {
+    int const c = _chunk_of(i);
+    node *chunk = __atomic_load_n(&_m_chunks[c], __ATOMIC_ACQUIRE);
+    return chunk + (i - _S_chunk_base * ((uint32_t(1) << c) - 1));
+  }
+
+  void _push(_t_tagged &head, uint32_t i) {
+    node *n = _node(i);
+    _t_tagged old = __atomic_load_n(&head, __ATOMIC_RELAXED);
+    _t_tagged desired;
+    do {
+      __atomic_store_n(&n->_m_next, _index(old), __ATOMIC_RELAXED);
+      desired = _make_tagged(i, _tag(old) + 1);
+    } while (!__atomic_compare_exchange_n(&head, &old, desired, true,
+                                          __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+  }
+
+  uint32_t _pop(_t_tagged &head) {
+    _t_tagged old = __atomic_load_n(&head, __ATOMIC_ACQUIRE);
+    _t_tagged desired;
+    do {
+      if (_index(old) == _S_null) {
+        return _S_null;
+      }
+      // may read a reused node, the tag makes the exchange fail in that case
+      uint32_t const next =
+          __atomic_load_n(&_node(_index(old))->_m_next, __ATOMIC_RELAXED);
+      desired = _make_tagged(next, _tag(old) + 1);
+    } while (!__atomic_compare_exchange_n(&head, &old, desired, true,
+                                          __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+    return _index(old);
+  }
+
+  uint32_t _acquire_node() {
+    uint32_t const i = _pop(_m_free);
+    return i != _S_null ? i : _new_node();
+  }
+
+  void _release_node(uint32_t i) { _push(_m_free, i); }
+
+  /*
+    Indices are handed out by a counter, the first thread to reach a chunk
+    allocates it and the losers of the race give their copy back.
+  */
+  uint32_t _new_node() {
+    uint32_t const i = __atomic_fetch_add(&_m_allocated, 1, __ATOMIC_RELAXED);
+    int const c = _chunk_of(i);
+    if (c >= _S_max_chunks) {
+      __atomic_fetch_sub(&_m_allocated, 1, __ATOMIC_RELAXED);
+      throw std::bad_alloc();
+    }
+    if (__atomic_load_n(&_m_chunks[c], __ATOMIC_ACQUIRE) == NULL) {
+      _t_node_allocator allocator(_m_allocator);
+      node *chunk = allocator.allocate(_chunk_size(c));
+      node *expected = NULL;
+      if (!__atomic_compare_exchange_n(&_m_chunks[c], &expected, chunk, false,
+                                       __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        allocator.deallocate(chunk, _chunk_size(c));
+      }
+    }
+    return i;
+  }
+};
+} // namespace ft
+
+#endif
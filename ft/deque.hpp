@@ -0,0 +1,823 @@
+#ifndef DEQUE_HPP
+#define DEQUE_HPP
+
+#include "algorithm.hpp"
+#include "allocator.hpp"
+#include "iterator.hpp"
+#include "type_traits.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+namespace ft {
+/* -------------------------------------------------------------------------- */
+/*                                 block size                                 */
+/* -------------------------------------------------------------------------- */
+/*
+  Elements live in fixed size blocks of about 4KiB, big elements get at least
+  16 slots per block so the map does not degenerate into a pointer array.
+  Blocks are raw allocator storage rather than ft::vector: push_front fills a
+  block from its end, which a vector cannot construct into.
+*/
+inline std::size_t deque_block_size(std::size_t size) {
+  return size < 256 ? std::size_t(4096 / size) : std::size_t(16);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                  iterator                                  */
+/* -------------------------------------------------------------------------- */
+template <typename _T_Value, typename _T_Ref, typename _T_Ptr>
+struct deque_iterator {
+  typedef deque_iterator<_T_Value, _T_Value &, _T_Value *> iterator;
+  typedef deque_iterator<_T_Value, _T_Value const &, _T_Value const *>
+      const_iterator;
+
+  typedef std::random_access_iterator_tag iterator_category;
+  typedef _T_Value value_type;
+  typedef _T_Ptr pointer;
+  typedef _T_Ref reference;
+  typedef std::ptrdiff_t difference_type;
+
+  typedef deque_iterator _t_self;
+  typedef _T_Value **_t_map_pointer;
+
+  _T_Value *_m_cur;
+  _T_Value *_m_first;
+  _T_Value *_m_last;
+  _t_map_pointer _m_node;
+
+  static difference_type _block_size() {
+    return deque_block_size(sizeof(_T_Value));
+  }
+
+  deque_iterator() : _m_cur(NULL), _m_first(NULL), _m_last(NULL), _m_node() {}
+
+  deque_iterator(_T_Value *x, _t_map_pointer y)
+      : _m_cur(x), _m_first(*y), _m_last(*y + _block_size()), _m_node(y) {}
+
+  deque_iterator(iterator const &x)
+      : _m_cur(x._m_cur), _m_first(x._m_first), _m_last(x._m_last),
+        _m_node(x._m_node) {}
+
+  void _set_node(_t_map_pointer new_node) {
+    _m_node = new_node;
+    _m_first = *new_node;
+    _m_last = _m_first + _block_size();
+  }
+
+  reference operator*() const { return *_m_cur; }
+
+  pointer operator->() const { return _m_cur; }
+
+  _t_self &operator++() {
+    ++_m_cur;
+    if (_m_cur == _m_last) {
+      _set_node(_m_node + 1);
+      _m_cur = _m_first;
+    }
+    return *this;
+  }
+
+  _t_self operator++(int) {
+    _t_self tmp = *this;
+    ++*this;
+    return tmp;
+  }
+
+  _t_self &operator--() {
+    if (_m_cur == _m_first) {
+      _set_node(_m_node - 1);
+      _m_cur = _m_last;
+    }
+    --_m_cur;
+    return *this;
+  }
+
+  _t_self operator--(int) {
+    _t_self tmp = *this;
+    --*this;
+    return tmp;
+  }
+
+  _t_self &operator+=(difference_type n) {
+    difference_type const offset = n + (_m_cur - _m_first);
+    if (offset >= 0 && offset < _block_size()) {
+      _m_cur += n;
+    } else {
+      difference_type const node_offset =
+          offset > 0 ? offset / _block_size()
+                     : -((-offset - 1) / _block_size()) - 1;
+      _set_node(_m_node + node_offset);
+      _m_cur = _m_first + (offset - node_offset * _block_size());
+    }
+    return *this;
+  }
+
+  _t_self operator+(difference_type n) const {
+    _t_self tmp = *this;
+    return tmp += n;
+  }
+
+  _t_self &operator-=(difference_type n) { return *this += -n; }
+
+  _t_self operator-(difference_type n) const {
+    _t_self tmp = *this;
+    return tmp -= n;
+  }
+
+  reference operator[](difference_type n) const { return *(*this + n); }
+};
+
+template <typename _T_Value, typename _T_RefL, typename _T_PtrL,
+          typename _T_RefR, typename _T_PtrR>
+inline bool operator==(deque_iterator<_T_Value, _T_RefL, _T_PtrL> const &lhs,
+                       deque_iterator<_T_Value, _T_RefR, _T_PtrR> const &rhs) {
+  return lhs._m_cur == rhs._m_cur;
+}
+
+template <typename _T_Value, typename _T_RefL, typename _T_PtrL,
+          typename _T_RefR, typename _T_PtrR>
+inline bool operator!=(deque_iterator<_T_Value, _T_RefL, _T_PtrL> const &lhs,
+                       deque_iterator<_T_Value, _T_RefR, _T_PtrR> const &rhs) {
+  return !(lhs == rhs);
+}
+
+template <typename _T_Value, typename _T_RefL, typename _T_PtrL,
+          typename _T_RefR, typename _T_PtrR>
+inline bool operator<(deque_iterator<_T_Value, _T_RefL, _T_PtrL> const &lhs,
+                      deque_iterator<_T_Value, _T_RefR, _T_PtrR> const &rhs) {
+  return lhs._m_node == rhs._m_node ? lhs._m_cur < rhs._m_cur
+                                    : lhs._m_node < rhs._m_node;
+}
+
+template <typename _T_Value, typename _T_RefL, typename _T_PtrL,
+          typename _T_RefR, typename _T_PtrR>
+inline bool operator>(deque_iterator<_T_Value, _T_RefL, _T_PtrL> const &lhs,
+                      deque_iterator<_T_Value, _T_RefR, _T_PtrR> const &rhs) {
+  return rhs < lhs;
+}
+
+template <typename _T_Value, typename _T_RefL, typename _T_PtrL,
+          typename _T_RefR, typename _T_PtrR>
+inline bool operator<=(deque_iterator<_T_Value, _T_RefL, _T_PtrL> const &lhs,
+                       deque_iterator<_T_Value, _T_RefR, _T_PtrR> const &rhs) {
+  return !(rhs < lhs);
+}
+
+template <typename _T_Value, typename _T_RefL, typename _T_PtrL,
+          typename _T_RefR, typename _T_PtrR>
+inline bool operator>=(deque_iterator<_T_Value, _T_RefL, _T_PtrL> const &lhs,
+                       deque_iterator<_T_Value, _T_RefR, _T_PtrR> const &rhs) {
+  return !(lhs < rhs);
+}
+
+template <typename _T_Value, typename _T_RefL, typename _T_PtrL,
+          typename _T_RefR, typename _T_PtrR>
+inline std::ptrdiff_t
+operator-(deque_iterator<_T_Value, _T_RefL, _T_PtrL> const &lhs,
+          deque_iterator<_T_Value, _T_RefR, _T_PtrR> const &rhs) {
+  return deque_iterator<_T_Value, _T_RefL, _T_PtrL>::_block_size() *
+             (lhs._m_node - rhs._m_node - 1) +
+         (lhs._m_cur - lhs._m_first) + (rhs._m_last - rhs._m_cur);
+}
+
+template <typename _T_Value, typename _T_Ref, typename _T_Ptr>
+inline deque_iterator<_T_Value, _T_Ref, _T_Ptr>
+operator+(std::ptrdiff_t n, deque_iterator<_T_Value, _T_Ref, _T_Ptr> const &i) {
+  return i + n;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                 deque base                                 */
+/* -------------------------------------------------------------------------- */
+template <typename _T_Value, typename _T_Allocator> struct deque_base {
+  typedef typename _T_Allocator::template rebind<_T_Value *>::other
+      _t_map_allocator;
+  typedef deque_iterator<_T_Value, _T_Value &, _T_Value *> iterator;
+  typedef _T_Value **_t_map_pointer;
+
+  struct deque_impl : public _T_Allocator {
+    _t_map_pointer _m_map;
+    std::size_t _m_map_size;
+    iterator _m_start;
+    iterator _m_finish;
+
+    deque_impl(_T_Allocator const &allocator)
+        : _T_Allocator(allocator), _m_map(NULL), _m_map_size(0), _m_start(),
+          _m_finish() {}
+  };
+
+  typedef _T_Allocator allocator_type;
+
+  enum { _S_initial_map_size = 8 };
+
+  deque_impl _m_impl;
+
+  deque_base(allocator_type const &allocator) : _m_impl(allocator) {
+    _initialize_map(0);
+  }
+
+  deque_base(std::size_t num_elements, allocator_type const &allocator)
+      : _m_impl(allocator) {
+    _initialize_map(num_elements);
+  }
+
+  ~deque_base() {
+    if (_m_impl._m_map) {
+      _destroy_nodes(_m_impl._m_start._m_node, _m_impl._m_finish._m_node + 1);
+      _deallocate_map(_m_impl._m_map, _m_impl._m_map_size);
+    }
+  }
+
+  static std::size_t _block_size() {
+    return deque_block_size(sizeof(_T_Value));
+  }
+
+  _T_Value *_allocate_node() { return _m_impl.allocate(_block_size()); }
+
+  void _deallocate_node(_T_Value *p) { _m_impl.deallocate(p, _block_size()); }
+
+  _t_map_pointer _allocate_map(std::size_t n) {
+    return _t_map_allocator(_m_impl).allocate(n);
+  }
+
+  void _deallocate_map(_t_map_pointer p, std::size_t n) {
+    _t_map_allocator(_m_impl).deallocate(p, n);
+  }
+
+  void _create_nodes(_t_map_pointer start, _t_map_pointer finish) {
+    _t_map_pointer cur = start;
+    try {
+      for (; cur < finish; ++cur) {
+        *cur = _allocate_node();
+      }
+    } catch (...) {
+      _destroy_nodes(start, cur);
+      throw;
+    }
+  }
+
+  void _destroy_nodes(_t_map_pointer start, _t_map_pointer finish) {
+    for (_t_map_pointer n = start; n < finish; ++n) {
+      _deallocate_node(*n);
+    }
+  }
+
+  /*
+    The used blocks are centered in the map so both ends can grow before the
+    map itself has to be reallocated.
+  */
+  void _initialize_map(std::size_t num_elements) {
+    std::size_t const num_nodes = num_elements / _block_size() + 1;
+    _m_impl._m_map_size =
+        std::max(std::size_t(_S_initial_map_size), num_nodes + 2);
+    _m_impl._m_map = _allocate_map(_m_impl._m_map_size);
+    _t_map_pointer start =
+        _m_impl._m_map + (_m_impl._m_map_size - num_nodes) / 2;
+    _t_map_pointer finish = start + num_nodes;
+    try {
+      _create_nodes(start, finish);
+    } catch (...) {
+      _deallocate_map(_m_impl._m_map, _m_impl._m_map_size);
+      _m_impl._m_map = NULL;
+      _m_impl._m_map_size = 0;
+      throw;
+    }
+    _m_impl._m_start._set_node(start);
+    _m_impl._m_finish._set_node(finish - 1);
+    _m_impl._m_start._m_cur = _m_impl._m_start._m_first;
+    _m_impl._m_finish._m_cur =
+        _m_impl._m_finish._m_first + num_elements % _block_size();
+  }
+};
+
+/* -------------------------------------------------------------------------- */
+/*                                    deque                                   */
+/* -------------------------------------------------------------------------- */
+template <typename _T_Value, typename _T_Allocator = std::allocator<_T_Value> >
+class deque : protected deque_base<_T_Value, _T_Allocator> {
+  /* -------------------------------- typedef ------------------------------- */
+  typedef deque_base<_T_Value, _T_Allocator> _t_deque_base;
+  typedef deque<_T_Value, _T_Allocator> _t_self;
+  typedef typename _t_deque_base::_t_map_pointer _t_map_pointer;
+
+public:
+  typedef _T_Value value_type;
+  typedef typename _t_deque_base::allocator_type allocator_type;
+  typedef typename allocator_type::pointer pointer;
+  typedef typename allocator_type::const_pointer const_pointer;
+  typedef typename allocator_type::reference reference;
+  typedef typename allocator_type::const_reference const_reference;
+  typedef typename allocator_type::size_type size_type;
+  typedef typename allocator_type::difference_type difference_type;
+  typedef deque_iterator<_T_Value, _T_Value &, _T_Value *> iterator;
+  typedef deque_iterator<_T_Value, _T_Value const &, _T_Value const *>
+      const_iterator;
+  typedef ft::reverse_iterator<const_iterator> const_reverse_iterator;
+  typedef ft::reverse_iterator<iterator> reverse_iterator;
+
+  /* ------------------------------ constructor ----------------------------- */
+  explicit deque(allocator_type const &alloc = allocator_type())
+      : _t_deque_base(alloc) {}
+
+  deque(size_type n, value_type const &val = value_type(),
+        allocator_type const &alloc = allocator_type())
+      : _t_deque_base(n, alloc) {
+    _fill_initialize(val);
+  }
+
+  deque(_t_self const &x) : _t_deque_base(x.size(), x.get_allocator()) {
+    _copy_initialize(x.begin(), x.end());
+  }
+
+  // see comment on vector range constructor
+  template <typename InputIterator>
+  deque(typename enable_if<!is_arithmetic<InputIterator>::value,
+                           InputIterator>::type first,
+        InputIterator last, allocator_type const &alloc = allocator_type())
+      : _t_deque_base(alloc) {
+    for (; first != last; ++first) {
+      push_back(*first);
+    }
+  }
+
+  /* ------------------------------ destructor ------------------------------ */
+  ~deque() { _destroy_range(begin(), end()); }
+
+  /* -------------------------------- assign -------------------------------- */
+  deque &operator=(deque const &x) {
+    if (&x != this) {
+      assign(x.begin(), x.end());
+    }
+    return *this;
+  }
+
+  void assign(size_type n, value_type const &val) {
+    if (n > size()) {
+      std::fill(begin(), end(), val);
+      insert(end(), n - size(), val);
+    } else {
+      erase(begin() + n, end());
+      std::fill(begin(), end(), val);
+    }
+  }
+
+  // see comment on vector range constructor
+  template <typename InputIterator>
+  void assign(typename enable_if<!is_arithmetic<InputIterator>::value,
+                                 InputIterator>::type first,
+              InputIterator last) {
+    iterator cur(begin());
+    for (; first != last && cur != end(); ++cur, ++first) {
+      *cur = *first;
+    }
+    if (first == last) {
+      erase(cur, end());
+    } else {
+      insert(end(), first, last);
+    }
+  }
+
+  /* ------------------------------- allocator ------------------------------ */
+  allocator_type get_allocator() const {
+    return *static_cast<allocator_type const *>(&this->_m_impl);
+  }
+
+  /* ------------------------------- iterator ------------------------------- */
+  iterator begin() { return this->_m_impl._m_start; }
+
+  const_iterator begin() const { return this->_m_impl._m_start; }
+
+  iterator end() { return this->_m_impl._m_finish; }
+
+  const_iterator end() const { return this->_m_impl._m_finish; }
+
+  reverse_iterator rbegin() { return reverse_iterator(end()); }
+
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+
+  reverse_iterator rend() { return reverse_iterator(begin()); }
+
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+
+  /* ------------------------------- capacity ------------------------------- */
+  bool empty() const {
+    return this->_m_impl._m_finish == this->_m_impl._m_start;
+  }
+
+  size_type size() const {
+    return this->_m_impl._m_finish - this->_m_impl._m_start;
+  }
+
+  size_type max_size() const {
+    return std::min(
+        static_cast<size_type>(std::numeric_limits<difference_type>::max()),
+        this->_m_impl.max_size());
+  }
+
+  /* ---------------------------- element access ---------------------------- */
+  reference operator[](size_type pos) { return this->_m_impl._m_start[pos]; }
+
+  const_reference operator[](size_type pos) const {
+    return this->_m_impl._m_start[pos];
+  }
+
+  reference at(size_type pos) {
+    if (pos >= this->size()) {
+      throw std::out_of_range("deque::at");
+    }
+    return (*this)[pos];
+  }
+
+  const_reference at(size_type pos) const {
+    if (pos >= this->size()) {
+      throw std::out_of_range("deque::at");
+    }
+    return (*this)[pos];
+  }
+
+  reference front() { return *begin(); }
+
+  const_reference front() const { return *begin(); }
+
+  reference back() { return *(end() - 1); }
+
+  const_reference back() const { return *(end() - 1); }
+
+  /* ------------------------------- modifiers ------------------------------ */
+  void push_back(value_type const &x) {
+    if (this->_m_impl._m_finish._m_cur != this->_m_impl._m_finish._m_last - 1) {
+      this->_m_impl.construct(this->_m_impl._m_finish._m_cur, x);
+      ++this->_m_impl._m_finish._m_cur;
+    } else {
+      _push_back_aux(x);
+    }
+  }
+
+  void push_front(value_type const &x) {
+    if (this->_m_impl._m_start._m_cur != this->_m_impl._m_start._m_first) {
+      this->_m_impl.construct(this->_m_impl._m_start._m_cur - 1, x);
+      --this->_m_impl._m_start._m_cur;
+    } else {
+      _push_front_aux(x);
+    }
+  }
+
+  void pop_back() {
+    if (this->_m_impl._m_finish._m_cur != this->_m_impl._m_finish._m_first) {
+      --this->_m_impl._m_finish._m_cur;
+      this->_m_impl.destroy(this->_m_impl._m_finish._m_cur);
+    } else {
+      this->_deallocate_node(this->_m_impl._m_finish._m_first);
+      this->_m_impl._m_finish._set_node(this->_m_impl._m_finish._m_node - 1);
+      this->_m_impl._m_finish._m_cur = this->_m_impl._m_finish._m_last - 1;
+      this->_m_impl.destroy(this->_m_impl._m_finish._m_cur);
+    }
+  }
+
+  void pop_front() {
+    if (this->_m_impl._m_start._m_cur != this->_m_impl._m_start._m_last - 1) {
+      this->_m_impl.destroy(this->_m_impl._m_start._m_cur);
+      ++this->_m_impl._m_start._m_cur;
+    } else {
+      this->_m_impl.destroy(this->_m_impl._m_start._m_cur);
+      this->_deallocate_node(this->_m_impl._m_start._m_first);
+      this->_m_impl._m_start._set_node(this->_m_impl._m_start._m_node + 1);
+      this->_m_impl._m_start._m_cur = this->_m_impl._m_start._m_first;
+    }
+  }
+
+  iterator insert(iterator position, value_type const &x) {
+    if (position._m_cur == this->_m_impl._m_start._m_cur) {
+      push_front(x);
+      return begin();
+    } else if (position._m_cur == this->_m_impl._m_finish._m_cur) {
+      push_back(x);
+      return end() - 1;
+    }
+    return _insert_aux(position, x);
+  }
+
+  void insert(iterator position, size_type n, value_type const &x) {
+    difference_type const index = position - begin();
+    size_type i = 0;
+    if (size_type(index) < size() / 2) {
+      try {
+        for (; i < n; ++i) {
+          push_front(x);
+        }
+      } catch (...) {
+        _pop_front_n(i);
+        throw;
+      }
+      std::rotate(begin(), begin() + n, begin() + n + index);
+    } else {
+      try {
+        for (; i < n; ++i) {
+          push_back(x);
+        }
+      } catch (...) {
+        _pop_back_n(i);
+        throw;
+      }
+      std::rotate(begin() + index, end() - n, end());
+    }
+  }
+
+  // see comment on vector range constructor
+  template <typename InputIterator>
+  void insert(iterator position,
+              typename enable_if<!is_arithmetic<InputIterator>::value,
+                                 InputIterator>::type first,
+              InputIterator last) {
+    difference_type const index = position - begin();
+    size_type n = 0;
+    if (size_type(index) < size() / 2) {
+      try {
+        for (; first != last; ++first, ++n) {
+          push_front(*first);
+        }
+      } catch (...) {
+        _pop_front_n(n);
+        throw;
+      }
+      std::reverse(begin(), begin() + n);
+      std::rotate(begin(), begin() + n, begin() + n + index);
+    } else {
+      try {
+        for (; first != last; ++first, ++n) {
+          push_back(*first);
+        }
+      } catch (...) {
+        _pop_back_n(n);
+        throw;
+      }
+      std::rotate(begin() + index, end() - n, end());
+    }
+  }
+
+  iterator erase(iterator position) {
+    iterator next = position;
+    ++next;
+    difference_type const index = position - begin();
+    if (size_type(index) < size() / 2) {
+      std::copy_backward(begin(), position, next);
+      pop_front();
+    } else {
+      std::copy(next, end(), position);
+      pop_back();
+    }
+    return begin() + index;
+  }
+
+  /*
+    Only the shortest side of the deque is shifted, the freed blocks are given
+    back right away.
+  */
+  iterator erase(iterator first, iterator last) {
+    if (first == begin() && last == end()) {
+      clear();
+      return end();
+    }
+    difference_type const n = last - first;
+    difference_type const elems_before = first - begin();
+    if (size_type(elems_before) < (size() - n) / 2) {
+      std::copy_backward(begin(), first, last);
+      iterator new_start = begin() + n;
+      _destroy_range(begin(), new_start);
+      this->_destroy_nodes(this->_m_impl._m_start._m_node,
+                           new_start._m_node);
+      this->_m_impl._m_start = new_start;
+    } else {
+      std::copy(last, end(), first);
+      iterator new_finish = end() - n;
+      _destroy_range(new_finish, end());
+      this->_destroy_nodes(new_finish._m_node + 1,
+                           this->_m_impl._m_finish._m_node + 1);
+      this->_m_impl._m_finish = new_finish;
+    }
+    return begin() + elems_before;
+  }
+
+  void resize(size_type count, value_type const &value) {
+    if (count < size()) {
+      erase(begin() + count, end());
+    } else {
+      insert(end(), count - size(), value);
+    }
+  }
+
+  void resize(size_type count) { resize(count, value_type()); }
+
+  void clear() {
+    _destroy_range(begin(), end());
+    this->_destroy_nodes(this->_m_impl._m_start._m_node + 1,
+                         this->_m_impl._m_finish._m_node + 1);
+    this->_m_impl._m_finish = this->_m_impl._m_start;
+  }
+
+  void swap(_t_self &other) {
+    std::swap(this->_m_impl._m_map, other._m_impl._m_map);
+    std::swap(this->_m_impl._m_map_size, other._m_impl._m_map_size);
+    std::swap(this->_m_impl._m_start, other._m_impl._m_start);
+    std::swap(this->_m_impl._m_finish, other._m_impl._m_finish);
+  }
+
+  /* -------------------------------- private ------------------------------- */
+private:
+  void _fill_initialize(value_type const &val) {
+    _t_map_pointer cur = this->_m_impl._m_start._m_node;
+    try {
+      for (; cur < this->_m_impl._m_finish._m_node; ++cur) {
+        uninitialized_fill_n_a(*cur, this->_block_size(), val,
+                               this->get_allocator());
+      }
+      uninitialized_fill_n_a(this->_m_impl._m_finish._m_first,
+                             this->_m_impl._m_finish._m_cur -
+                                 this->_m_impl._m_finish._m_first,
+                             val, this->get_allocator());
+    } catch (...) {
+      _destroy_range(this->_m_impl._m_start, iterator(*cur, cur));
+      throw;
+    }
+  }
+
+  void _copy_initialize(const_iterator first, const_iterator last) {
+    uninitialized_copy_a(first, last, this->_m_impl._m_start,
+                         this->get_allocator());
+  }
+
+  void _destroy_range(iterator first, iterator last) {
+    destroy_a(first, last, this->get_allocator());
+  }
+
+  void _pop_front_n(size_type n) {
+    for (; n > 0; --n) {
+      pop_front();
+    }
+  }
+
+  void _pop_back_n(size_type n) {
+    for (; n > 0; --n) {
+      pop_back();
+    }
+  }
+
+  // the last slot of a block is filled only when the next block exists
+  void _push_back_aux(value_type const &x) {
+    _reserve_map_at_back(1);
+    *(this->_m_impl._m_finish._m_node + 1) = this->_allocate_node();
+    try {
+      this->_m_impl.construct(this->_m_impl._m_finish._m_cur, x);
+    } catch (...) {
+      this->_deallocate_node(*(this->_m_impl._m_finish._m_node + 1));
+      throw;
+    }
+    this->_m_impl._m_finish._set_node(this->_m_impl._m_finish._m_node + 1);
+    this->_m_impl._m_finish._m_cur = this->_m_impl._m_finish._m_first;
+  }
+
+  void _push_front_aux(value_type const &x) {
+    _reserve_map_at_front(1);
+    *(this->_m_impl._m_start._m_node - 1) = this->_allocate_node();
+    try {
+      this->_m_impl._m_start._set_node(this->_m_impl._m_start._m_node - 1);
+      this->_m_impl._m_start._m_cur = this->_m_impl._m_start._m_last - 1;
+      this->_m_impl.construct(this->_m_impl._m_start._m_cur, x);
+    } catch (...) {
+      ++this->_m_impl._m_start;
+      this->_deallocate_node(*(this->_m_impl._m_start._m_node - 1));
+      throw;
+    }
+  }
+
+  iterator _insert_aux(iterator position, value_type const &x) {
+    value_type x_copy = x;
+    difference_type const index = position - begin();
+    if (size_type(index) < size() / 2) {
+      push_front(front());
+      iterator front1 = begin() + 1;
+      iterator front2 = front1 + 1;
+      position = begin() + index;
+      std::copy(front2, position + 1, front1);
+    } else {
+      push_back(back());
+      iterator back1 = end() - 1;
+      iterator back2 = back1 - 1;
+      position = begin() + index;
+      std::copy_backward(position, back2, back1);
+    }
+    *position = x_copy;
+    return position;
+  }
+
+  void _reserve_map_at_back(size_type nodes_to_add) {
+    if (nodes_to_add + 1 >
+        this->_m_impl._m_map_size -
+            (this->_m_impl._m_finish._m_node - this->_m_impl._m_map)) {
+      _reallocate_map(nodes_to_add, false);
+    }
+  }
+
+  void _reserve_map_at_front(size_type nodes_to_add) {
+    if (nodes_to_add >
+        size_type(this->_m_impl._m_start._m_node - this->_m_impl._m_map)) {
+      _reallocate_map(nodes_to_add, true);
+    }
+  }
+
+  /*
+    Only block pointers are moved here, the elements themselves never are. The
+    used part is recentered in place when the map is mostly free, otherwise the
+    map at least doubles.
+  */
+  void _reallocate_map(size_type nodes_to_add, bool add_at_front) {
+    size_type const old_num_nodes = this->_m_impl._m_finish._m_node -
+                                    this->_m_impl._m_start._m_node + 1;
+    size_type const new_num_nodes = old_num_nodes + nodes_to_add;
+    _t_map_pointer new_start;
+    if (this->_m_impl._m_map_size > 2 * new_num_nodes) {
+      new_start = this->_m_impl._m_map +
+                  (this->_m_impl._m_map_size - new_num_nodes) / 2 +
+                  (add_at_front ? nodes_to_add : 0);
+      if (new_start < this->_m_impl._m_start._m_node) {
+        std::copy(this->_m_impl._m_start._m_node,
+                  this->_m_impl._m_finish._m_node + 1, new_start);
+      } else {
+        std::copy_backward(this->_m_impl._m_start._m_node,
+                           this->_m_impl._m_finish._m_node + 1,
+                           new_start + old_num_nodes);
+      }
+    } else {
+      size_type const new_map_size =
+          this->_m_impl._m_map_size +
+          std::max(this->_m_impl._m_map_size, nodes_to_add) + 2;
+      _t_map_pointer new_map = this->_allocate_map(new_map_size);
+      new_start = new_map + (new_map_size - new_num_nodes) / 2 +
+                  (add_at_front ? nodes_to_add : 0);
+      std::copy(this->_m_impl._m_start._m_node,
+                this->_m_impl._m_finish._m_node + 1, new_start);
+      this->_deallocate_map(this->_m_impl._m_map, this->_m_impl._m_map_size);
+      this->_m_impl._m_map = new_map;
+      this->_m_impl._m_map_size = new_map_size;
+    }
+    this->_m_impl._m_start._set_node(new_start);
+    this->_m_impl._m_finish._set_node(new_start + old_num_nodes - 1);
+  }
+};
+
+/* -------------------------- non-member functions -------------------------- */
+template <typename _T_Value, typename _T_Allocator>
+inline void swap(deque<_T_Value, _T_Allocator> &lhs,
+                 deque<_T_Value, _T_Allocator> &rhs) {
+  lhs.swap(rhs);
+}
+
+template <typename _T_Value, typename _T_Allocator>
+inline bool operator==(deque<_T_Value, _T_Allocator> const &lhs,
+                       deque<_T_Value, _T_Allocator> const &rhs) {
+  return (lhs.size() == rhs.size() &&
+          ft::equal(lhs.begin(), lhs.end(), rhs.begin()));
+}
+
+template <typename _T_Value, typename _T_Allocator>
+inline bool operator<(deque<_T_Value, _T_Allocator> const &lhs,
+                      deque<_T_Value, _T_Allocator> const &rhs) {
+  return ft::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(),
+                                     rhs.end());
+}
+
+template <typename _T_Value, typename _T_Allocator>
+inline bool operator!=(deque<_T_Value, _T_Allocator> const &lhs,
+                       deque<_T_Value, _T_Allocator> const &rhs) {
+  return !(lhs == rhs);
+}
+
+template <typename _T_Value, typename _T_Allocator>
+inline bool operator>(deque<_T_Value, _T_Allocator> const &lhs,
+                      deque<_T_Value, _T_Allocator> const &rhs) {
+  return rhs < lhs;
+}
+
+template <typename _T_Value, typename _T_Allocator>
+inline bool operator<=(deque<_T_Value, _T_Allocator> const &lhs,
+                       deque<_T_Value, _T_Allocator> const &rhs) {
+  return !(rhs < lhs);
+}
+
+template <typename _T_Value, typename _T_Allocator>
+inline bool operator>=(deque<_T_Value, _T_Allocator> const &lhs,
+                       deque<_T_Value, _T_Allocator> const &rhs) {
+  return !(lhs < rhs);
+}
+} // namespace ft
+
+#endif
@@ -0,0 +1,328 @@
+#ifndef INTERVAL_MAP_HPP
+#define INTERVAL_MAP_HPP
+
+#include "functions.hpp"
+#include "tree.hpp"
+#include "type_traits.hpp"
+
+#include <functional>
+#include <memory>
+
+namespace ft {
+/* -------------------------------------------------------------------------- */
+/*                                  interval                                  */
+/* -------------------------------------------------------------------------- */
+// closed, [low, high] with low <= high
+template <typename _T_Bound> struct interval {
+  _T_Bound low;
+  _T_Bound high;
+
+  interval() : low(), high() {}
+
+  interval(_T_Bound const &l, _T_Bound const &h) : low(l), high(h) {}
+};
+
+// by low bound, then by high bound
+template <typename _T_Bound, typename _T_Compare>
+class interval_less
+    : public binary_function<interval<_T_Bound>, interval<_T_Bound>, bool> {
+  _T_Compare _m_comp;
+
+public:
+  interval_less(_T_Compare const &comp = _T_Compare()) : _m_comp(comp) {}
+
+  _T_Compare bound_comp() const { return _m_comp; }
+
+  bool operator()(interval<_T_Bound> const &x,
+                  interval<_T_Bound> const &y) const {
+    return _m_comp(x.low, y.low) ||
+           (!_m_comp(y.low, x.low) && _m_comp(x.high, y.high));
+  }
+};
+
+/* -------------------------------------------------------------------------- */
+/*                                    node                                    */
+/* -------------------------------------------------------------------------- */
+/*
+  Caches the largest high bound of its subtree. The bound is assigned, never
+  constructed in the node, so it must be a scalar (a number or a pointer),
+  other bounds do not compile. The callback has no map at hand and builds
+  its own comparator, which is why interval_map takes none.
+*/
+template <typename _T_Val, typename _T_Bound, typename _T_Compare>
+struct interval_map_node : public Rb_tree_node<_T_Val> {
+  typedef char _t_bound_is_scalar[is_scalar<_T_Bound>::value ? 1 : -1];
+
+  _T_Bound _m_max;
+
+  static Rb_tree_augment_fn augment() { return &_update; }
+
+  static _T_Bound const &_max(Rb_tree_node_base const *x) {
+    return static_cast<interval_map_node const *>(x)->_m_max;
+  }
+
+  static void _update(Rb_tree_node_base *x) {
+    interval_map_node *const n = static_cast<interval_map_node *>(x);
+    _T_Compare comp;
+    _T_Bound const *max = &n->_m_value.first.high;
+    if (x->_m_left != NULL && comp(*max, _max(x->_m_left))) {
+      max = &_max(x->_m_left);
+    }
+    if (x->_m_right != NULL && comp(*max, _max(x->_m_right))) {
+      max = &_max(x->_m_right);
+    }
+    n->_m_max = *max;
+  }
+};
+
+/* -------------------------------------------------------------------------- */
+/*                                interval map                                */
+/* -------------------------------------------------------------------------- */
+/*
+  Map from closed intervals to values, ordered by low then high bound, with
+  the queries of an interval tree: every node caches the largest high bound
+  of its subtree, so a search skips the subtrees that end before the query
+  and stops at the nodes that start after it. Reporting the k intervals that
+  overlap a query visits O(min(n, (k + 1) log n)) nodes, against all n for a
+  scan of an ordered map.
+
+  The bound comparator is always default constructed, the constructors take
+  no comparator: a stateful one would disagree with the node callback.
+*/
+template <typename _T_Bound, typename _T_Val,
+          typename _T_Compare = std::less<_T_Bound>,
+          typename _T_Allocator =
+              std::allocator<pair<const interval<_T_Bound>, _T_Val> > >
+class interval_map {
+
+  /* ------------------------------- typedefs ------------------------------- */
+public:
+  typedef _T_Bound bound_type;
+  typedef interval<_T_Bound> key_type;
+  typedef _T_Val mapped_type;
+  typedef pair<const key_type, _T_Val> value_type;
+  typedef _T_Compare bound_compare;
+  typedef interval_less<_T_Bound, _T_Compare> key_compare;
+
+private:
+  typedef interval_map_node<value_type, _T_Bound, _T_Compare> _t_node;
+  typedef Rb_tree<key_type, value_type, Select1st<value_type>, key_compare,
+                  _T_Allocator, _t_node>
+      _t_tree_type;
+  typedef Rb_tree_node_base const *_t_const_base_ptr;
+  typedef Rb_tree_node<value_type> *_t_node_ptr;
+  _t_tree_type _m_tree;
+
+public:
+  typedef typename _t_tree_type::pointer pointer;
+  typedef typename _t_tree_type::const_pointer const_pointer;
+  typedef typename _t_tree_type::reference reference;
+  typedef typename _t_tree_type::const_reference const_reference;
+  typedef typename _t_tree_type::iterator iterator;
+  typedef typename _t_tree_type::const_iterator const_iterator;
+  typedef typename _t_tree_type::reverse_iterator reverse_iterator;
+  typedef typename _t_tree_type::const_reverse_iterator const_reverse_iterator;
+  typedef typename _t_tree_type::size_type size_type;
+  typedef typename _t_tree_type::difference_type difference_type;
+  typedef typename _t_tree_type::allocator_type allocator_type;
+
+  /* ------------------------------ constructor ----------------------------- */
+  explicit interval_map(allocator_type const &a = allocator_type())
+      : _m_tree(key_compare(), a) {}
+
+  template <class _T_InputIterator>
+  interval_map(_T_InputIterator first, _T_InputIterator last,
+               allocator_type const &a = allocator_type())
+      : _m_tree(key_compare(), a) {
+    _m_tree.insert(first, last);
+  }
+
+  interval_map(interval_map const &x) : _m_tree(x._m_tree) {}
+
+  /* ---------------------------- assign operator --------------------------- */
+  interval_map &operator=(interval_map const &x) {
+    _m_tree = x._m_tree;
+    return *this;
+  }
+
+  /* ------------------------------- observer ------------------------------- */
+  key_compare key_comp() const { return _m_tree.key_comp(); }
+
+  bound_compare bound_comp() const { return _m_tree.key_comp().bound_comp(); }
+
+  /* ------------------------------- allocator ------------------------------ */
+  allocator_type get_allocator() const { return _m_tree.get_allocator(); }
+
+  /* ------------------------------- iterator ------------------------------- */
+  iterator begin() { return _m_tree.begin(); }
+
+  const_iterator begin() const { return _m_tree.begin(); }
+
+  iterator end() { return _m_tree.end(); }
+
+  const_iterator end() const { return _m_tree.end(); }
+
+  reverse_iterator rbegin() { return _m_tree.rbegin(); }
+
+  const_reverse_iterator rbegin() const { return _m_tree.rbegin(); }
+
+  reverse_iterator rend() { return _m_tree.rend(); }
+
+  const_reverse_iterator rend() const { return _m_tree.rend(); }
+
+  /* ------------------------------- capacity ------------------------------- */
+  bool empty() const { return _m_tree.empty(); }
+
+  size_type size() const { return _m_tree.size(); }
+
+  size_type max_size() const { return _m_tree.max_size(); }
+
+  /* ------------------------------- modifier ------------------------------- */
+  void swap(interval_map &x) { _m_tree.swap(x._m_tree); }
+
+  pair<iterator, bool> insert(value_type const &x) { return _m_tree.insert(x); }
+
+  iterator insert(iterator position, value_type const &x) {
+    return _m_tree.insert(position, x);
+  }
+
+  template <typename _T_InputIterator>
+  void insert(_T_InputIterator first, _T_InputIterator last) {
+    _m_tree.insert(first, last);
+  }
+
+  void erase(iterator position) { _m_tree.erase(position); }
+
+  size_type erase(key_type const &x) { return _m_tree.erase(x); }
+
+  void erase(iterator first, iterator last) { _m_tree.erase(first, last); }
+
+  void clear() { _m_tree.clear(); }
+
+  /* -------------------------------- lookup -------------------------------- */
+  iterator find(key_type const &x) { return _m_tree.find(x); }
+
+  const_iterator find(key_type const &x) const { return _m_tree.find(x); }
+
+  size_type count(key_type const &x) const {
+    return _m_tree.find(x) == _m_tree.end() ? 0 : 1;
+  }
+
+  iterator lower_bound(key_type const &x) { return _m_tree.lower_bound(x); }
+
+  const_iterator lower_bound(key_type const &x) const {
+    return _m_tree.lower_bound(x);
+  }
+
+  iterator upper_bound(key_type const &x) { return _m_tree.upper_bound(x); }
+
+  const_iterator upper_bound(key_type const &x) const {
+    return _m_tree.upper_bound(x);
+  }
+
+  /* ---------------------------- overlap queries --------------------------- */
+  // first interval overlapping q in key order, or end(), O(log n)
+  iterator find_overlap(key_type const &q) {
+    _t_const_base_ptr const x = _find_overlap(q);
+    return x == NULL ? end() : iterator(_node(x));
+  }
+
+  const_iterator find_overlap(key_type const &q) const {
+    _t_const_base_ptr const x = _find_overlap(q);
+    return x == NULL ? end() : const_iterator(_node(x));
+  }
+
+  // writes an iterator to every interval overlapping q, in key order
+  template <typename _T_OutputIterator>
+  _T_OutputIterator overlapping(key_type const &q, _T_OutputIterator out) {
+    return _overlapping<iterator>(_m_tree.root(), q, bound_comp(), out);
+  }
+
+  template <typename _T_OutputIterator>
+  _T_OutputIterator overlapping(key_type const &q,
+                                _T_OutputIterator out) const {
+    return _overlapping<const_iterator>(_m_tree.root(), q, bound_comp(), out);
+  }
+
+  // the intervals containing p
+  template <typename _T_OutputIterator>
+  _T_OutputIterator stabbing(bound_type const &p, _T_OutputIterator out) {
+    return overlapping(key_type(p, p), out);
+  }
+
+  template <typename _T_OutputIterator>
+  _T_OutputIterator stabbing(bound_type const &p,
+                             _T_OutputIterator out) const {
+    return overlapping(key_type(p, p), out);
+  }
+
+  /* ----------------------------- introspection ---------------------------- */
+  // shape of the underlying red-black tree, O(n)
+  Rb_tree_stats tree_stats() const { return _m_tree.stats(); }
+
+  /* -------------------------------- private ------------------------------- */
+private:
+  static _t_node_ptr _node(_t_const_base_ptr x) {
+    return static_cast<_t_node_ptr>(const_cast<Rb_tree_node_base *>(x));
+  }
+
+  static key_type const &_key(_t_const_base_ptr x) {
+    return static_cast<_t_node const *>(x)->_m_value.first;
+  }
+
+  /*
+    When the left subtree reaches q.low, it holds the answer if there is
+    one: an interval there that does not overlap starts after q.high, and so
+    does everything to its right.
+  */
+  _t_const_base_ptr _find_overlap(key_type const &q) const {
+    bound_compare const comp = bound_comp();
+    _t_const_base_ptr x = _m_tree.root();
+    while (x != NULL) {
+      if (x->_m_left != NULL && !comp(_t_node::_max(x->_m_left), q.low)) {
+        x = x->_m_left;
+        continue;
+      }
+      key_type const &k = _key(x);
+      if (comp(q.high, k.low)) {
+        return NULL;
+      }
+      if (!comp(k.high, q.low)) {
+        return x;
+      }
+      x = x->_m_right;
+    }
+    return NULL;
+  }
+
+  // in order, the right subtree in the loop and the left one recursively
+  template <typename _T_Iterator, typename _T_OutputIterator>
+  static _T_OutputIterator _overlapping(_t_const_base_ptr x, key_type const &q,
+                                        bound_compare const &comp,
+                                        _T_OutputIterator out) {
+    while (x != NULL && !comp(_t_node::_max(x), q.low)) {
+      out = _overlapping<_T_Iterator>(x->_m_left, q, comp, out);
+      key_type const &k = _key(x);
+      if (comp(q.high, k.low)) {
+        break;
+      }
+      if (!comp(k.high, q.low)) {
+        *out = _T_Iterator(_node(x));
+        ++out;
+      }
+      x = x->_m_right;
+    }
+    return out;
+  }
+};
+
+/* ------------------------------- non members ------------------------------ */
+template <typename _T_Bound, typename _T_Val, typename _T_Compare,
+          typename _T_Alloc>
+inline void swap(interval_map<_T_Bound, _T_Val, _T_Compare, _T_Alloc> &lhs,
+                 interval_map<_T_Bound, _T_Val, _T_Compare, _T_Alloc> &rhs) {
+  lhs.swap(rhs);
+}
+} // namespace ft
+
+#endif
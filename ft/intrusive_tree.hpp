@@ -0,0 +1,433 @@
+#ifndef INTRUSIVE_TREE_HPP
+#define INTRUSIVE_TREE_HPP
+
+#include "iterator.hpp"
+#include "tree.hpp"
+#include "utility.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+
+namespace ft {
+/* -------------------------------------------------------------------------- */
+/*                                    hook                                    */
+/* -------------------------------------------------------------------------- */
+/*
+  Links of an object in one intrusive tree. The object derives from one hook
+  per tree it can be in, the tag type telling them apart:
+
+    struct order : intrusive_hook<by_id>, intrusive_hook<by_price> { ... };
+
+  An unlinked hook has no parent, a linked one always has, the header for the
+  root. Copying an object does not copy its links.
+*/
+template <typename _T_Tag = void>
+struct intrusive_hook : public Rb_tree_node_base {
+  intrusive_hook() { _reset(); }
+
+  intrusive_hook(intrusive_hook const &) : Rb_tree_node_base() { _reset(); }
+
+  intrusive_hook &operator=(intrusive_hook const &) { return *this; }
+
+  bool is_linked() const { return this->_m_parent != NULL; }
+
+  void _reset() {
+    this->_m_color = RBT_RED;
+    this->_m_parent = NULL;
+    this->_m_left = NULL;
+    this->_m_right = NULL;
+  }
+};
+
+/* -------------------------------------------------------------------------- */
+/*                                  iterator                                  */
+/* -------------------------------------------------------------------------- */
+template <typename _T_Val, typename _T_Tag> struct intrusive_tree_iterator {
+  typedef _T_Val value_type;
+  typedef _T_Val &reference;
+  typedef _T_Val *pointer;
+
+  typedef std::bidirectional_iterator_tag iterator_category;
+  typedef std::ptrdiff_t difference_type;
+
+  typedef intrusive_tree_iterator<_T_Val, _T_Tag> _t_self;
+  typedef Rb_tree_node_base::_t_base_ptr _t_base_ptr;
+  typedef intrusive_hook<_T_Tag> *_t_hook_ptr;
+
+  _t_base_ptr _m_node;
+
+  intrusive_tree_iterator() : _m_node() {}
+
+  explicit intrusive_tree_iterator(_t_base_ptr x) : _m_node(x) {}
+
+  reference operator*() const {
+    return *static_cast<pointer>(static_cast<_t_hook_ptr>(_m_node));
+  }
+
+  pointer operator->() const {
+    return static_cast<pointer>(static_cast<_t_hook_ptr>(_m_node));
+  }
+
+  _t_self &operator++() {
+    _m_node = Rb_tree_next(_m_node);
+    return *this;
+  }
+
+  _t_self operator++(int) {
+    _t_self tmp = *this;
+    _m_node = Rb_tree_next(_m_node);
+    return tmp;
+  }
+
+  _t_self &operator--() {
+    _m_node = Rb_tree_prev(_m_node);
+    return *this;
+  }
+
+  _t_self operator--(int) {
+    _t_self tmp = *this;
+    _m_node = Rb_tree_prev(_m_node);
+    return tmp;
+  }
+
+  friend bool operator==(_t_self const &lhs, _t_self const &rhs) {
+    return lhs._m_node == rhs._m_node;
+  }
+
+  friend bool operator!=(_t_self const &lhs, _t_self const &rhs) {
+    return lhs._m_node != rhs._m_node;
+  }
+};
+
+/* -------------------------------------------------------------------------- */
+/*                               const iterator                               */
+/* -------------------------------------------------------------------------- */
+template <typename _T_Val, typename _T_Tag>
+struct intrusive_tree_const_iterator {
+  typedef _T_Val value_type;
+  typedef _T_Val const &reference;
+  typedef _T_Val const *pointer;
+
+  typedef intrusive_tree_iterator<_T_Val, _T_Tag> iterator;
+
+  typedef std::bidirectional_iterator_tag iterator_category;
+  typedef std::ptrdiff_t difference_type;
+
+  typedef intrusive_tree_const_iterator<_T_Val, _T_Tag> _t_self;
+  typedef Rb_tree_node_base::_t_const_base_ptr _t_base_ptr;
+  typedef intrusive_hook<_T_Tag> const *_t_hook_ptr;
+
+  _t_base_ptr _m_node;
+
+  intrusive_tree_const_iterator() : _m_node() {}
+
+  explicit intrusive_tree_const_iterator(_t_base_ptr x) : _m_node(x) {}
+
+  intrusive_tree_const_iterator(iterator const &it) : _m_node(it._m_node) {}
+
+  reference operator*() const {
+    return *static_cast<pointer>(static_cast<_t_hook_ptr>(_m_node));
+  }
+
+  pointer operator->() const {
+    return static_cast<pointer>(static_cast<_t_hook_ptr>(_m_node));
+  }
+
+  _t_self &operator++() {
+    _m_node = Rb_tree_next(_m_node);
+    return *this;
+  }
+
+  _t_self operator++(int) {
+    _t_self tmp = *this;
+    _m_node = Rb_tree_next(_m_node);
+    return tmp;
+  }
+
+  _t_self &operator--() {
+    _m_node = Rb_tree_prev(_m_node);
+    return *this;
+  }
+
+  _t_self operator--(int) {
+    _t_self tmp = *this;
+    _m_node = Rb_tree_prev(_m_node);
+    return tmp;
+  }
+
+  friend bool operator==(_t_self const &lhs, _t_self const &rhs) {
+    return lhs._m_node == rhs._m_node;
+  }
+
+  friend bool operator!=(_t_self const &lhs, _t_self const &rhs) {
+    return lhs._m_node != rhs._m_node;
+  }
+};
+
+/* -------------------------------------------------------------------------- */
+/*                               intrusive tree                               */
+/* -------------------------------------------------------------------------- */
+/*
+  Red-black tree over objects owned by the caller, linked through their
+  intrusive_hook<_T_Tag> base: inserting allocates and copies nothing, and an
+  object with several hooks can be in several trees at once. Same balancing
+  code as Rb_tree.
+
+  The tree never owns its values. An object must be unlinked before it is
+  destroyed and its key must not change while it is linked. clear and the
+  destructor unlink every object, O(n). Trees cannot be copied.
+*/
+template <typename _T_Key, typename _T_Val, typename _T_KeyOfValue,
+          typename _T_Compare = std::less<_T_Key>, typename _T_Tag = void>
+class intrusive_tree {
+
+  /* -------------------------------- typedef ------------------------------- */
+  typedef Rb_tree_node_base *_t_base_ptr;
+  typedef Rb_tree_node_base const *_t_const_base_ptr;
+
+public:
+  typedef _T_Key key_type;
+  typedef _T_Val value_type;
+  typedef _T_Compare key_compare;
+  typedef intrusive_hook<_T_Tag> hook_type;
+  typedef value_type *pointer;
+  typedef value_type const *const_pointer;
+  typedef value_type &reference;
+  typedef value_type const &const_reference;
+  typedef std::size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+
+  typedef intrusive_tree_iterator<_T_Val, _T_Tag> iterator;
+  typedef intrusive_tree_const_iterator<_T_Val, _T_Tag> const_iterator;
+  typedef ft::reverse_iterator<iterator> reverse_iterator;
+  typedef ft::reverse_iterator<const_iterator> const_reverse_iterator;
+
+  /* ------------------------------ constructor ----------------------------- */
+  explicit intrusive_tree(key_compare const &comp = key_compare())
+      : _m_key_compare(comp), _m_node_count(0) {
+    this->_m_header._m_color = RBT_RED;
+    this->_m_header._m_parent = NULL;
+    this->_m_header._m_left = &this->_m_header;
+    this->_m_header._m_right = &this->_m_header;
+    Rb_tree_relink_header(this->_m_header);
+  }
+
+  /* ------------------------------ destructor ------------------------------ */
+  ~intrusive_tree() { _unlink_all(_root()); }
+
+  /* ------------------------------- observer ------------------------------- */
+  key_compare key_comp() const { return _m_key_compare; }
+
+  /* ------------------------------- iterator ------------------------------- */
+  iterator begin() { return iterator(this->_m_header._m_left); }
+
+  const_iterator begin() const {
+    return const_iterator(this->_m_header._m_left);
+  }
+
+  iterator end() { return iterator(&this->_m_header); }
+
+  const_iterator end() const { return const_iterator(&this->_m_header); }
+
+  reverse_iterator rbegin() { return reverse_iterator(end()); }
+
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+
+  reverse_iterator rend() { return reverse_iterator(begin()); }
+
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+
+  // iterator to a linked object, O(1)
+  static iterator iterator_to(reference v) {
+    return iterator(static_cast<hook_type *>(&v));
+  }
+
+  static const_iterator iterator_to(const_reference v) {
+    return const_iterator(static_cast<hook_type const *>(&v));
+  }
+
+  /* ------------------------------- capacity ------------------------------- */
+  bool empty() const { return _m_node_count == 0; }
+
+  size_type size() const { return _m_node_count; }
+
+  /* ----------------------------- introspection ---------------------------- */
+  // walks the whole tree, O(n)
+  Rb_tree_stats stats() const { return Rb_tree_compute_stats(_root()); }
+
+  /* ------------------------------- modifier ------------------------------- */
+  // links v unless an equivalent key is already there, v must be unlinked
+  pair<iterator, bool> insert(reference v) {
+    key_type const &k = _T_KeyOfValue()(v);
+    _t_base_ptr x = _root();
+    _t_base_ptr y = &this->_m_header;
+    bool comp = true;
+    while (x != NULL) {
+      y = x;
+      comp = _m_key_compare(k, _key(x));
+      x = comp ? x->_m_left : x->_m_right;
+    }
+    iterator j(y);
+    if (comp) {
+      if (j == begin()) {
+        return pair<iterator, bool>(_link(true, y, v), true);
+      }
+      --j;
+    }
+    if (_m_key_compare(_key(j._m_node), k)) {
+      return pair<iterator, bool>(_link(comp, y, v), true);
+    }
+    return pair<iterator, bool>(j, false);
+  }
+
+  // links v after the objects with an equivalent key
+  iterator insert_equal(reference v) {
+    key_type const &k = _T_KeyOfValue()(v);
+    _t_base_ptr x = _root();
+    _t_base_ptr y = &this->_m_header;
+    bool comp = true;
+    while (x != NULL) {
+      y = x;
+      comp = _m_key_compare(k, _key(x));
+      x = comp ? x->_m_left : x->_m_right;
+    }
+    return _link(comp, y, v);
+  }
+
+  void erase(iterator position) {
+    _t_base_ptr z = Rb_tree_rebalance_for_erase(position._m_node, _m_header);
+    static_cast<hook_type *>(z)->_reset();
+    --_m_node_count;
+  }
+
+  // v must be linked in this tree, no lookup
+  void unlink(reference v) {
+    assert(static_cast<hook_type &>(v).is_linked());
+    erase(iterator_to(v));
+  }
+
+  size_type erase(key_type const &k) {
+    iterator first = lower_bound(k);
+    iterator const last = upper_bound(k);
+    size_type n = 0;
+    while (first != last) {
+      erase(first++);
+      ++n;
+    }
+    return n;
+  }
+
+  void clear() {
+    _unlink_all(_root());
+    this->_m_header._m_parent = NULL;
+    this->_m_header._m_left = &this->_m_header;
+    this->_m_header._m_right = &this->_m_header;
+    Rb_tree_relink_header(this->_m_header);
+    _m_node_count = 0;
+  }
+
+  /* -------------------------------- lookup -------------------------------- */
+  iterator find(key_type const &k) {
+    iterator j = lower_bound(k);
+    return (j == end() || _m_key_compare(k, _key(j._m_node))) ? end() : j;
+  }
+
+  const_iterator find(key_type const &k) const {
+    const_iterator j = lower_bound(k);
+    return (j == end() || _m_key_compare(k, _key(j._m_node))) ? end() : j;
+  }
+
+  size_type count(key_type const &k) const {
+    return std::distance(lower_bound(k), upper_bound(k));
+  }
+
+  iterator lower_bound(key_type const &k) { return iterator(_lower_bound(k)); }
+
+  const_iterator lower_bound(key_type const &k) const {
+    return const_iterator(_lower_bound(k));
+  }
+
+  iterator upper_bound(key_type const &k) { return iterator(_upper_bound(k)); }
+
+  const_iterator upper_bound(key_type const &k) const {
+    return const_iterator(_upper_bound(k));
+  }
+
+  pair<iterator, iterator> equal_range(key_type const &k) {
+    return pair<iterator, iterator>(lower_bound(k), upper_bound(k));
+  }
+
+  pair<const_iterator, const_iterator> equal_range(key_type const &k) const {
+    return pair<const_iterator, const_iterator>(lower_bound(k), upper_bound(k));
+  }
+
+  /* -------------------------------- private ------------------------------- */
+private:
+  Rb_tree_node_base _m_header;
+  key_compare _m_key_compare;
+  size_type _m_node_count;
+
+  intrusive_tree(intrusive_tree const &);
+  intrusive_tree &operator=(intrusive_tree const &);
+
+  _t_base_ptr _root() const { return this->_m_header._m_parent; }
+
+  static key_type const &_key(_t_const_base_ptr x) {
+    return _T_KeyOfValue()(
+        *static_cast<const_pointer>(static_cast<hook_type const *>(x)));
+  }
+
+  iterator _link(bool insert_left, _t_base_ptr p, reference v) {
+    hook_type *const z = &v;
+    assert(!z->is_linked());
+    Rb_tree_insert_and_rebalance(insert_left || p == &this->_m_header, z, p,
+                                 _m_header);
+    ++_m_node_count;
+    return iterator(z);
+  }
+
+  // the header is never written through these
+  _t_base_ptr _lower_bound(key_type const &k) const {
+    _t_base_ptr x = _root();
+    _t_base_ptr y = const_cast<_t_base_ptr>(&this->_m_header);
+    while (x != NULL) {
+      if (!_m_key_compare(_key(x), k)) {
+        y = x, x = x->_m_left;
+      } else {
+        x = x->_m_right;
+      }
+    }
+    return y;
+  }
+
+  _t_base_ptr _upper_bound(key_type const &k) const {
+    _t_base_ptr x = _root();
+    _t_base_ptr y = const_cast<_t_base_ptr>(&this->_m_header);
+    while (x != NULL) {
+      if (_m_key_compare(k, _key(x))) {
+        y = x, x = x->_m_left;
+      } else {
+        x = x->_m_right;
+      }
+    }
+    return y;
+  }
+
+  static void _unlink_all(_t_base_ptr x) {
+    while (x != NULL) {
+      _unlink_all(x->_m_right);
+      _t_base_ptr const y = x->_m_left;
+      static_cast<hook_type *>(x)->_reset();
+      x = y;
+    }
+  }
+};
+} // namespace ft
+
+#endif
@@ -150,6 +150,28 @@ public:
   void insert(_T_InputIterator first, _T_InputIterator last) {
     _m_tree.insert(first, last);
   }
+
+  template <typename _T_Arg1> pair<iterator, bool> emplace(_T_Arg1 const &a1) {
+    return _m_tree.emplace_unique(emplace_args1<_T_Arg1>(a1));
+  }
+
+  template <typename _T_Arg1, typename _T_Arg2>
+  pair<iterator, bool> emplace(_T_Arg1 const &a1, _T_Arg2 const &a2) {
+    return _m_tree.emplace_unique(emplace_args2<_T_Arg1, _T_Arg2>(a1, a2));
+  }
+
+  template <typename _T_Arg1>
+  iterator emplace_hint(iterator position, _T_Arg1 const &a1) {
+    return _m_tree.emplace_hint_unique(position, emplace_args1<_T_Arg1>(a1));
+  }
+
+  template <typename _T_Arg1, typename _T_Arg2>
+  iterator emplace_hint(iterator position, _T_Arg1 const &a1,
+                        _T_Arg2 const &a2) {
+    return _m_tree.emplace_hint_unique(
+        position, emplace_args2<_T_Arg1, _T_Arg2>(a1, a2));
+  }
+
   void erase(iterator position) { _m_tree.erase(position); }
 
   size_type erase(key_type const &x) { return _m_tree.erase(x); }
@@ -187,6 +209,10 @@ public:
     return _m_tree.equal_range(x);
   }
 
+  /* ----------------------------- introspection ---------------------------- */
+  // shape of the underlying red-black tree, O(n)
+  Rb_tree_stats tree_stats() const { return _m_tree.stats(); }
+
   /* ------------------------------- operators ------------------------------ */
   template <typename _T_K, typename _T_V, typename _T_C, typename _T_A>
   friend bool operator==(map<_T_K, _T_V, _T_C, _T_A> const &,
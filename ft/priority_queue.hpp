@@ -0,0 +1,321 @@
+#ifndef PRIORITY_QUEUE_HPP
+#define PRIORITY_QUEUE_HPP
+
+#include "utility.hpp"
+#include "vector.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+
+namespace ft {
+/* -------------------------------------------------------------------------- */
+/*                                 d-ary heap                                 */
+/* -------------------------------------------------------------------------- */
+/*
+  Max-heap with Arity children per node, node i has its children at
+  [Arity * i + 1, Arity * i + Arity]. A wider node makes the heap shallower:
+  push does fewer steps, pop compares more children per level but they share
+  a cache line. Same contract as std::push_heap and std::pop_heap.
+*/
+template <std::size_t Arity> struct d_ary_heap {
+  typedef char _t_arity_is_at_least_two[Arity >= 2 ? 1 : -1];
+
+  static std::size_t parent(std::size_t i) { return (i - 1) / Arity; }
+
+  static std::size_t first_child(std::size_t i) { return Arity * i + 1; }
+
+  // moves value up from hole, where the slot is free
+  template <typename RandomIt, typename T, typename Compare>
+  static void sift_up(RandomIt first, std::size_t hole, T const &value,
+                      Compare comp) {
+    while (hole > 0) {
+      std::size_t const p = parent(hole);
+      if (!comp(first[p], value)) {
+        break;
+      }
+      first[hole] = first[p];
+      hole = p;
+    }
+    first[hole] = value;
+  }
+
+  // moves value down from hole, where the slot is free
+  template <typename RandomIt, typename T, typename Compare>
+  static void sift_down(RandomIt first, std::size_t len, std::size_t hole,
+                        T const &value, Compare comp) {
+    for (;;) {
+      std::size_t const child = first_child(hole);
+      if (child >= len) {
+        break;
+      }
+      std::size_t const last = child + Arity < len ? child + Arity : len;
+      std::size_t best = child;
+      for (std::size_t c = child + 1; c < last; ++c) {
+        if (comp(first[best], first[c])) {
+          best = c;
+        }
+      }
+      if (!comp(value, first[best])) {
+        break;
+      }
+      first[hole] = first[best];
+      hole = best;
+    }
+    first[hole] = value;
+  }
+
+  /*
+    Floyd's construction: sifting every inner node down, starting from the
+    last one, is O(n) where n pushes would be O(n log n).
+  */
+  template <typename RandomIt, typename Compare>
+  static void make(RandomIt first, RandomIt last, Compare comp) {
+    std::size_t const len = last - first;
+    if (len < 2) {
+      return;
+    }
+    for (std::size_t i = parent(len - 1) + 1; i > 0; --i) {
+      typename std::iterator_traits<RandomIt>::value_type value(first[i - 1]);
+      sift_down(first, len, i - 1, value, comp);
+    }
+  }
+
+  // [first, last - 1) is a heap, last - 1 is inserted
+  template <typename RandomIt, typename Compare>
+  static void push(RandomIt first, RandomIt last, Compare comp) {
+    typename std::iterator_traits<RandomIt>::value_type value(*(last - 1));
+    sift_up(first, last - first - 1, value, comp);
+  }
+
+  // moves the top to last - 1, [first, last - 1) is a heap afterwards
+  template <typename RandomIt, typename Compare>
+  static void pop(RandomIt first, RandomIt last, Compare comp) {
+    std::size_t const len = last - first;
+    if (len < 2) {
+      return;
+    }
+    typename std::iterator_traits<RandomIt>::value_type value(*(last - 1));
+    *(last - 1) = *first;
+    sift_down(first, len - 1, 0, value, comp);
+  }
+};
+
+/* -------------------------------------------------------------------------- */
+/*                               priority queue                               */
+/* -------------------------------------------------------------------------- */
+template <class T, class Container = vector<T>,
+          class Compare = std::less<typename Container::value_type>,
+          std::size_t Arity = 2>
+class priority_queue {
+  typedef d_ary_heap<Arity> _t_heap;
+
+public:
+  typedef typename Container::value_type value_type;
+  typedef typename Container::size_type size_type;
+  typedef typename Container::reference reference;
+  typedef typename Container::const_reference const_reference;
+  typedef Container container_type;
+  typedef Compare value_compare;
+
+protected:
+  container_type c_;
+  value_compare comp_;
+
+public:
+  /* ------------------------------ constructor ----------------------------- */
+  explicit priority_queue(value_compare const &comp = value_compare(),
+                          container_type const &c = container_type())
+      : c_(c), comp_(comp) {
+    _t_heap::make(c_.begin(), c_.end(), comp_);
+  }
+
+  // bulk construction, O(n)
+  template <class InputIterator>
+  priority_queue(InputIterator first, InputIterator last,
+                 value_compare const &comp = value_compare(),
+                 container_type const &c = container_type())
+      : c_(c), comp_(comp) {
+    c_.insert(c_.end(), first, last);
+    _t_heap::make(c_.begin(), c_.end(), comp_);
+  }
+
+  /* ---------------------------- element access ---------------------------- */
+  const_reference top() const { return c_.front(); }
+
+  /* ------------------------------- capacity ------------------------------- */
+  bool empty() const { return c_.empty(); }
+
+  size_type size() const { return c_.size(); }
+
+  /* ------------------------------- modifiers ------------------------------ */
+  void push(value_type const &x) {
+    c_.push_back(x);
+    _t_heap::push(c_.begin(), c_.end(), comp_);
+  }
+
+  void pop() {
+    _t_heap::pop(c_.begin(), c_.end(), comp_);
+    c_.pop_back();
+  }
+};
+
+/* -------------------------------------------------------------------------- */
+/*                           indexed priority queue                           */
+/* -------------------------------------------------------------------------- */
+/*
+  Priority queue over handles in [0, capacity), each handle is in the queue at
+  most once with a value that can be changed in place (decrease-key and
+  increase-key), as needed by Dijkstra-like schedulers. A table gives the heap
+  position of every handle so update and erase are O(log n) instead of a
+  linear search. The values live in the heap next to their handle, sifting
+  compares neighbours without going through the table.
+*/
+template <class T, class Compare = std::less<T>, std::size_t Arity = 2>
+class indexed_priority_queue {
+  typedef d_ary_heap<Arity> _t_heap;
+
+public:
+  typedef T value_type;
+  typedef std::size_t size_type;
+  typedef std::size_t handle_type;
+  typedef Compare value_compare;
+
+  static size_type const npos = static_cast<size_type>(-1);
+
+private:
+  typedef pair<value_type, handle_type> _t_entry;
+
+public:
+  /* ------------------------------ constructor ----------------------------- */
+  explicit indexed_priority_queue(size_type capacity,
+                                  value_compare const &comp = value_compare())
+      : _m_positions(capacity, npos), _m_comp(comp) {
+    _m_heap.reserve(capacity);
+  }
+
+  /* ---------------------------- element access ---------------------------- */
+  handle_type top_handle() const { return _m_heap.front().second; }
+
+  value_type const &top() const { return _m_heap.front().first; }
+
+  value_type const &value(handle_type h) const {
+    return _m_heap[_m_positions[h]].first;
+  }
+
+  /* ------------------------------- capacity ------------------------------- */
+  bool empty() const { return _m_heap.empty(); }
+
+  size_type size() const { return _m_heap.size(); }
+
+  size_type capacity() const { return _m_positions.size(); }
+
+  bool contains(handle_type h) const {
+    return h < capacity() && _m_positions[h] != npos;
+  }
+
+  /* ------------------------------- modifiers ------------------------------ */
+  void push(handle_type h, value_type const &x) {
+    if (h >= capacity()) {
+      throw std::out_of_range("indexed_priority_queue::push");
+    }
+    if (contains(h)) {
+      update(h, x);
+      return;
+    }
+    _t_entry const entry(x, h);
+    _m_heap.push_back(entry);
+    _sift_up(_m_heap.size() - 1, entry);
+  }
+
+  void pop() { erase(top_handle()); }
+
+  // changes the value of a queued handle, in either direction
+  void update(handle_type h, value_type const &x) {
+    size_type const pos = _m_positions[h];
+    bool const up = _m_comp(_m_heap[pos].first, x);
+    _t_entry const entry(x, h);
+    if (up) {
+      _sift_up(pos, entry);
+    } else {
+      _sift_down(pos, entry);
+    }
+  }
+
+  void erase(handle_type h) {
+    size_type const pos = _m_positions[h];
+    _t_entry const last = _m_heap.back();
+    _m_heap.pop_back();
+    _m_positions[h] = npos;
+    if (last.second != h) {
+      // the moved entry may have to go either way
+      if (pos > 0 && _m_comp(_m_heap[_t_heap::parent(pos)].first, last.first)) {
+        _sift_up(pos, last);
+      } else {
+        _sift_down(pos, last);
+      }
+    }
+  }
+
+  void clear() {
+    for (size_type i = 0; i < _m_heap.size(); ++i) {
+      _m_positions[_m_heap[i].second] = npos;
+    }
+    _m_heap.clear();
+  }
+
+  /* -------------------------------- private ------------------------------- */
+private:
+  vector<_t_entry> _m_heap;
+  vector<size_type> _m_positions;
+  value_compare _m_comp;
+
+  void _place(size_type pos, _t_entry const &e) {
+    _m_heap[pos] = e;
+    _m_positions[e.second] = pos;
+  }
+
+  // same as d_ary_heap::sift_up, keeping the position table in sync
+  void _sift_up(size_type hole, _t_entry const &e) {
+    while (hole > 0) {
+      size_type const p = _t_heap::parent(hole);
+      if (!_m_comp(_m_heap[p].first, e.first)) {
+        break;
+      }
+      _place(hole, _m_heap[p]);
+      hole = p;
+    }
+    _place(hole, e);
+  }
+
+  void _sift_down(size_type hole, _t_entry const &e) {
+    size_type const len = _m_heap.size();
+    for (;;) {
+      size_type const child = _t_heap::first_child(hole);
+      if (child >= len) {
+        break;
+      }
+      size_type const last = child + Arity < len ? child + Arity : len;
+      size_type best = child;
+      for (size_type c = child + 1; c < last; ++c) {
+        if (_m_comp(_m_heap[best].first, _m_heap[c].first)) {
+          best = c;
+        }
+      }
+      if (!_m_comp(e.first, _m_heap[best].first)) {
+        break;
+      }
+      _place(hole, _m_heap[best]);
+      hole = best;
+    }
+    _place(hole, e);
+  }
+};
+
+template <class T, class Compare, std::size_t Arity>
+typename indexed_priority_queue<T, Compare, Arity>::size_type const
+    indexed_priority_queue<T, Compare, Arity>::npos;
+} // namespace ft
+
+#endif
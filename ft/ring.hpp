@@ -0,0 +1,312 @@
+#ifndef RING_HPP
+#define RING_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+
+#ifndef FT_CACHE_LINE_SIZE
+#define FT_CACHE_LINE_SIZE 64
+#endif
+
+namespace ft {
+/* -------------------------------------------------------------------------- */
+/*                                  spsc ring                                 */
+/* -------------------------------------------------------------------------- */
+/*
+  Bounded queue for exactly one producer thread and one consumer thread.
+
+  Positions are free running counters, the slot is the position masked with
+  N - 1, so N must be a power of two. The producer only writes the tail and
+  the consumer only writes the head, each on its own cache line. Both sides
+  keep a private copy of the other side's counter and only reload the shared
+  one when the copy says the ring is full (empty), which keeps the cache line
+  of the other side from bouncing on every operation.
+
+  Relies on the GCC/Clang __atomic builtins, the C++98 library has no atomics.
+*/
+template <typename _T_Value, std::size_t N,
+          typename _T_Allocator = std::allocator<_T_Value> >
+class spsc_ring {
+  typedef char _t_capacity_is_power_of_two[(N >= 2 && (N & (N - 1)) == 0)
+                                               ? 1
+                                               : -1];
+
+public:
+  typedef _T_Value value_type;
+  typedef _T_Allocator allocator_type;
+  typedef typename allocator_type::size_type size_type;
+
+  /* ------------------------------ constructor ----------------------------- */
+  explicit spsc_ring(allocator_type const &alloc = allocator_type())
+      : _m_allocator(alloc), _m_buffer(_m_allocator.allocate(N)), _m_head(0),
+        _m_tail_cache(0), _m_tail(0), _m_head_cache(0) {}
+
+  /* ------------------------------ destructor ------------------------------ */
+  ~spsc_ring() {
+    for (size_type i = _m_head; i != _m_tail; ++i) {
+      _m_allocator.destroy(_m_buffer + (i & (N - 1)));
+    }
+    _m_allocator.deallocate(_m_buffer, N);
+  }
+
+  /* ------------------------------- capacity ------------------------------- */
+  static size_type capacity() { return N; }
+
+  // snapshot, may be outdated as soon as it returns
+  size_type size() const {
+    return __atomic_load_n(&_m_tail, __ATOMIC_ACQUIRE) -
+           __atomic_load_n(&_m_head, __ATOMIC_ACQUIRE);
+  }
+
+  bool empty() const { return size() == 0; }
+
+  /* ------------------------------- producer ------------------------------- */
+  // false when the ring is full
+  bool try_push(value_type const &x) { return try_push_n(&x, 1) == 1; }
+
+  /*
+    Pushes up to n elements and publishes them with a single store, returns
+    how many fit.
+  */
+  template <typename InputIterator>
+  size_type try_push_n(InputIterator first, size_type n) {
+    size_type const tail = _m_tail;
+    if (tail + n - _m_head_cache > N) {
+      _m_head_cache = __atomic_load_n(&_m_head, __ATOMIC_ACQUIRE);
+    }
+    size_type const count = std::min(n, N - (tail - _m_head_cache));
+    size_type i = 0;
+    try {
+      for (; i < count; ++i, ++first) {
+        _m_allocator.construct(_m_buffer + ((tail + i) & (N - 1)), *first);
+      }
+    } catch (...) {
+      __atomic_store_n(&_m_tail, tail + i, __ATOMIC_RELEASE);
+      throw;
+    }
+    __atomic_store_n(&_m_tail, tail + count, __ATOMIC_RELEASE);
+    return count;
+  }
+
+  /* ------------------------------- consumer ------------------------------- */
+  // false when the ring is empty
+  bool try_pop(value_type &out) { return try_pop_n(&out, 1) == 1; }
+
+  // pops up to n elements into out, returns how many were available
+  template <typename OutputIterator>
+  size_type try_pop_n(OutputIterator out, size_type n) {
+    size_type const head = _m_head;
+    if (_m_tail_cache - head < n) {
+      _m_tail_cache = __atomic_load_n(&_m_tail, __ATOMIC_ACQUIRE);
+    }
+    size_type const count = std::min(n, _m_tail_cache - head);
+    size_type i = 0;
+    try {
+      for (; i < count; ++i, ++out) {
+        value_type *slot = _m_buffer + ((head + i) & (N - 1));
+        *out = *slot;
+        _m_allocator.destroy(slot);
+      }
+    } catch (...) {
+      __atomic_store_n(&_m_head, head + i, __ATOMIC_RELEASE);
+      throw;
+    }
+    __atomic_store_n(&_m_head, head + count, __ATOMIC_RELEASE);
+    return count;
+  }
+
+  /* -------------------------------- private ------------------------------- */
+private:
+  allocator_type _m_allocator;
+  value_type *const _m_buffer;
+  char _m_pad0[FT_CACHE_LINE_SIZE];
+  // consumer side
+  size_type _m_head;
+  size_type _m_tail_cache;
+  char _m_pad1[FT_CACHE_LINE_SIZE];
+  // producer side
+  size_type _m_tail;
+  size_type _m_head_cache;
+  char _m_pad2[FT_CACHE_LINE_SIZE];
+
+  spsc_ring(spsc_ring const &);
+  spsc_ring &operator=(spsc_ring const &);
+};
+
+/* -------------------------------------------------------------------------- */
+/*                                  mpmc ring                                 */
+/* -------------------------------------------------------------------------- */
+/*
+  Bounded queue for any number of producers and consumers (Vyukov's scheme).
+
+  Every cell carries a sequence number telling which position may use it
+  next: a producer may fill the cell of position p when its sequence is p, a
+  consumer may empty it when its sequence is p + 1. Producers and consumers
+  claim positions with a compare and swap on their own padded counter, the
+  cells are then filled or emptied without further synchronization. Batched
+  operations claim a whole run of ready cells with one compare and swap.
+
+  A push whose copy throws has already claimed its cells: they are released
+  empty and the consumers skip them, so a pop may return less than the ring
+  held (try_pop false) while the ring is not empty yet.
+
+  The capacity is rounded up to a power of two.
+*/
+template <typename _T_Value, typename _T_Allocator = std::allocator<_T_Value> >
+class mpmc_ring {
+  struct cell {
+    std::size_t _m_sequence;
+    bool _m_full; // false when the push of the cell threw
+    _T_Value _m_value;
+  };
+
+  typedef typename _T_Allocator::template rebind<cell>::other _t_cell_allocator;
+
+public:
+  typedef _T_Value value_type;
+  typedef _T_Allocator allocator_type;
+  typedef typename allocator_type::size_type size_type;
+
+  /* ------------------------------ constructor ----------------------------- */
+  explicit mpmc_ring(size_type capacity,
+                     allocator_type const &alloc = allocator_type())
+      : _m_allocator(alloc), _m_mask(_round_up(capacity) - 1),
+        _m_cells(_t_cell_allocator(_m_allocator).allocate(_m_mask + 1)),
+        _m_enqueue_pos(0), _m_dequeue_pos(0) {
+    for (size_type i = 0; i <= _m_mask; ++i) {
+      _m_cells[i]._m_sequence = i;
+    }
+  }
+
+  /* ------------------------------ destructor ------------------------------ */
+  ~mpmc_ring() {
+    for (size_type i = _m_dequeue_pos; i != _m_enqueue_pos; ++i) {
+      if (_m_cells[i & _m_mask]._m_full) {
+        _m_allocator.destroy(&_m_cells[i & _m_mask]._m_value);
+      }
+    }
+    _t_cell_allocator(_m_allocator).deallocate(_m_cells, _m_mask + 1);
+  }
+
+  /* ------------------------------- capacity ------------------------------- */
+  size_type capacity() const { return _m_mask + 1; }
+
+  // snapshot, may be outdated as soon as it returns
+  size_type size() const {
+    size_type const tail = __atomic_load_n(&_m_enqueue_pos, __ATOMIC_ACQUIRE);
+    size_type const head = __atomic_load_n(&_m_dequeue_pos, __ATOMIC_ACQUIRE);
+    return tail > head ? tail - head : 0;
+  }
+
+  bool empty() const { return size() == 0; }
+
+  /* ------------------------------- producer ------------------------------- */
+  // false when the ring is full
+  bool try_push(value_type const &x) { return try_push_n(&x, 1) == 1; }
+
+  // pushes up to n elements, returns how many fit
+  template <typename InputIterator>
+  size_type try_push_n(InputIterator first, size_type n) {
+    size_type pos;
+    size_type const count = _claim(_m_enqueue_pos, 0, n, pos);
+    size_type i = 0;
+    try {
+      for (; i < count; ++i, ++first) {
+        cell *c = &_m_cells[(pos + i) & _m_mask];
+        _m_allocator.construct(&c->_m_value, *first);
+        c->_m_full = true;
+        __atomic_store_n(&c->_m_sequence, pos + i + 1, __ATOMIC_RELEASE);
+      }
+    } catch (...) {
+      // the rest of the run is claimed, release it empty or it is lost
+      for (; i < count; ++i) {
+        cell *c = &_m_cells[(pos + i) & _m_mask];
+        c->_m_full = false;
+        __atomic_store_n(&c->_m_sequence, pos + i + 1, __ATOMIC_RELEASE);
+      }
+      throw;
+    }
+    return count;
+  }
+
+  /* ------------------------------- consumer ------------------------------- */
+  // false when the ring is empty
+  bool try_pop(value_type &out) { return try_pop_n(&out, 1) == 1; }
+
+  // pops up to n elements into out, returns how many were written
+  template <typename OutputIterator>
+  size_type try_pop_n(OutputIterator out, size_type n) {
+    size_type pos;
+    size_type const count = _claim(_m_dequeue_pos, 1, n, pos);
+    size_type popped = 0;
+    for (size_type i = 0; i < count; ++i) {
+      cell *c = &_m_cells[(pos + i) & _m_mask];
+      if (c->_m_full) {
+        *out = c->_m_value;
+        ++out;
+        ++popped;
+        _m_allocator.destroy(&c->_m_value);
+      }
+      __atomic_store_n(&c->_m_sequence, pos + i + _m_mask + 1,
+                       __ATOMIC_RELEASE);
+    }
+    return popped;
+  }
+
+  /* -------------------------------- private ------------------------------- */
+private:
+  allocator_type _m_allocator;
+  size_type const _m_mask;
+  cell *const _m_cells;
+  char _m_pad0[FT_CACHE_LINE_SIZE];
+  size_type _m_enqueue_pos;
+  char _m_pad1[FT_CACHE_LINE_SIZE];
+  size_type _m_dequeue_pos;
+  char _m_pad2[FT_CACHE_LINE_SIZE];
+
+  mpmc_ring(mpmc_ring const &);
+  mpmc_ring &operator=(mpmc_ring const &);
+
+  static size_type _round_up(size_type n) {
+    size_type capacity = 2;
+    while (capacity < n) {
+      capacity <<= 1;
+    }
+    return capacity;
+  }
+
+  /*
+    Claims the longest run, up to n, of cells whose sequence is position +
+    offset, starting at the current value of counter. Returns the length of
+    the run, the first claimed position is stored in pos.
+  */
+  size_type _claim(size_type &counter, size_type offset, size_type n,
+                   size_type &pos) {
+    pos = __atomic_load_n(&counter, __ATOMIC_RELAXED);
+    for (;;) {
+      size_type count = 0;
+      while (count < n && count <= _m_mask &&
+             __atomic_load_n(&_m_cells[(pos + count) & _m_mask]._m_sequence,
+                             __ATOMIC_ACQUIRE) == pos + count + offset) {
+        ++count;
+      }
+      if (count == 0) {
+        size_type const seq = __atomic_load_n(
+            &_m_cells[pos & _m_mask]._m_sequence, __ATOMIC_ACQUIRE);
+        // behind the counter: the ring is full (empty)
+        if (seq < pos + offset) {
+          return 0;
+        }
+        pos = __atomic_load_n(&counter, __ATOMIC_RELAXED);
+      } else if (__atomic_compare_exchange_n(&counter, &pos, pos + count,
+                                             true, __ATOMIC_RELAXED,
+                                             __ATOMIC_RELAXED)) {
+        return count;
+      }
+    }
+  }
+};
+} // namespace ft
+
+#endif
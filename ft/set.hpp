@@ -107,6 +107,51 @@ public:
     _m_tree.insert(first, last);
   }
 
+  template <typename _T_Arg1> pair<iterator, bool> emplace(_T_Arg1 const &a1) {
+    pair<typename _t_tree_type::iterator, bool> p =
+        _m_tree.emplace_unique(emplace_args1<_T_Arg1>(a1));
+    return pair<iterator, bool>(p.first, p.second);
+  }
+
+  template <typename _T_Arg1, typename _T_Arg2>
+  pair<iterator, bool> emplace(_T_Arg1 const &a1, _T_Arg2 const &a2) {
+    pair<typename _t_tree_type::iterator, bool> p =
+        _m_tree.emplace_unique(emplace_args2<_T_Arg1, _T_Arg2>(a1, a2));
+    return pair<iterator, bool>(p.first, p.second);
+  }
+
+  template <typename _T_Arg1, typename _T_Arg2, typename _T_Arg3>
+  pair<iterator, bool> emplace(_T_Arg1 const &a1, _T_Arg2 const &a2,
+                               _T_Arg3 const &a3) {
+    pair<typename _t_tree_type::iterator, bool> p = _m_tree.emplace_unique(
+        emplace_args3<_T_Arg1, _T_Arg2, _T_Arg3>(a1, a2, a3));
+    return pair<iterator, bool>(p.first, p.second);
+  }
+
+  template <typename _T_Arg1>
+  iterator emplace_hint(iterator position, _T_Arg1 const &a1) {
+    typedef typename _t_tree_type::iterator _t_tree_iterator;
+    return _m_tree.emplace_hint_unique((_t_tree_iterator &)position,
+                                       emplace_args1<_T_Arg1>(a1));
+  }
+
+  template <typename _T_Arg1, typename _T_Arg2>
+  iterator emplace_hint(iterator position, _T_Arg1 const &a1,
+                        _T_Arg2 const &a2) {
+    typedef typename _t_tree_type::iterator _t_tree_iterator;
+    return _m_tree.emplace_hint_unique(
+        (_t_tree_iterator &)position, emplace_args2<_T_Arg1, _T_Arg2>(a1, a2));
+  }
+
+  template <typename _T_Arg1, typename _T_Arg2, typename _T_Arg3>
+  iterator emplace_hint(iterator position, _T_Arg1 const &a1,
+                        _T_Arg2 const &a2, _T_Arg3 const &a3) {
+    typedef typename _t_tree_type::iterator _t_tree_iterator;
+    return _m_tree.emplace_hint_unique(
+        (_t_tree_iterator &)position,
+        emplace_args3<_T_Arg1, _T_Arg2, _T_Arg3>(a1, a2, a3));
+  }
+
   void erase(iterator position) {
     typedef typename _t_tree_type::iterator _t_tree_iterator;
     _m_tree.erase((_t_tree_iterator &)position);
@@ -140,6 +185,10 @@ public:
     return _m_tree.equal_range(x);
   }
 
+  /* ----------------------------- introspection ---------------------------- */
+  // shape of the underlying red-black tree, O(n)
+  Rb_tree_stats tree_stats() const { return _m_tree.stats(); }
+
   /* ------------------------------- operators ------------------------------ */
   template <typename _T_K, typename _T_C, typename _T_A>
   friend bool operator==(set<_T_K, _T_C, _T_A> const &,
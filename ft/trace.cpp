@@ -0,0 +1,95 @@
+#include "trace.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <time.h>
+
+namespace ft {
+typedef char _t_trace_capacity_is_power_of_two
+    [(FT_TRACE_CAPACITY & (FT_TRACE_CAPACITY - 1)) == 0 ? 1 : -1];
+
+static trace_ring s_trace_ring;
+static uint32_t s_trace_threads = 0;
+static __thread uint32_t s_trace_thread = 0; // 0 until the first record
+
+char const *trace_event_name(trace_event_type type) {
+  static char const *const names[] = {"vector reallocate", "node allocate",
+                                      "node deallocate", "insert rebalance",
+                                      "erase rebalance"};
+  return type < TRACE_EVENT_TYPE_COUNT ? names[type] : "unknown";
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                 trace ring                                 */
+/* -------------------------------------------------------------------------- */
+void trace_ring::record(trace_event_type type, std::size_t size) {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  if (s_trace_thread == 0) {
+    s_trace_thread = __atomic_add_fetch(&s_trace_threads, 1, __ATOMIC_RELAXED);
+  }
+  std::size_t const i =
+      __atomic_fetch_add(&_m_next, 1, __ATOMIC_RELAXED);
+  trace_event &e = _m_events[i & (FT_TRACE_CAPACITY - 1)];
+  e.timestamp = uint64_t(t.tv_sec) * 1000000000 + t.tv_nsec;
+  e.size = size;
+  e.type = type;
+  e.thread = s_trace_thread - 1;
+}
+
+std::size_t trace_ring::recorded() const {
+  return __atomic_load_n(&_m_next, __ATOMIC_RELAXED);
+}
+
+std::size_t trace_ring::read(trace_event *out, std::size_t n) const {
+  std::size_t const next = recorded();
+  std::size_t const count =
+      std::min(n, std::min<std::size_t>(next, FT_TRACE_CAPACITY));
+  for (std::size_t i = next - count; i != next; ++i) {
+    *out++ = _m_events[i & (FT_TRACE_CAPACITY - 1)];
+  }
+  return count;
+}
+
+void trace_ring::clear() {
+  __atomic_store_n(&_m_next, 0, __ATOMIC_RELAXED);
+}
+
+bool trace_ring::dump(char const *path) const {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    return false;
+  }
+  std::size_t const next = recorded();
+  header h;
+  std::memcpy(h.magic, "FTTRACE", sizeof(h.magic));
+  h.version = 1;
+  h.event_size = sizeof(trace_event);
+  h.count = std::min<std::size_t>(next, FT_TRACE_CAPACITY);
+  h.dropped = next - h.count;
+  out.write(reinterpret_cast<char const *>(&h), sizeof(h));
+  // oldest first: the part of the ring after the next slot, then the rest
+  std::size_t const first = next - h.count;
+  for (std::size_t i = first; i != next;) {
+    std::size_t const slot = i & (FT_TRACE_CAPACITY - 1);
+    std::size_t const run =
+        std::min<std::size_t>(next - i, FT_TRACE_CAPACITY - slot);
+    out.write(reinterpret_cast<char const *>(_m_events + slot),
+              run * sizeof(trace_event));
+    i += run;
+  }
+  return bool(out);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                 ring trace                                 */
+/* -------------------------------------------------------------------------- */
+trace_ring &ring_trace::ring() { return s_trace_ring; }
+
+void ring_trace::record(trace_event_type type, std::size_t size) {
+  s_trace_ring.record(type, size);
+}
+
+bool ring_trace::dump(char const *path) { return s_trace_ring.dump(path); }
+} // namespace ft
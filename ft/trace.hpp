@@ -0,0 +1,104 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <cstddef>
+#include <stdint.h>
+
+#ifndef FT_TRACE_CAPACITY
+#define FT_TRACE_CAPACITY 65536
+#endif
+
+namespace ft {
+/* -------------------------------------------------------------------------- */
+/*                                   events                                   */
+/* -------------------------------------------------------------------------- */
+enum trace_event_type {
+  TRACE_VECTOR_REALLOCATE, // size: bytes of the new storage
+  TRACE_NODE_ALLOCATE,     // size: bytes of the node
+  TRACE_NODE_DEALLOCATE,   // size: bytes of the node
+  TRACE_INSERT_REBALANCE,  // size: fix-up steps up the tree
+  TRACE_ERASE_REBALANCE,   // size: fix-up steps up the tree
+  TRACE_EVENT_TYPE_COUNT
+};
+
+// the record of the binary dump, in the byte order of the host
+struct trace_event {
+  uint64_t timestamp; // nanoseconds, CLOCK_MONOTONIC
+  uint64_t size;
+  uint32_t type;
+  uint32_t thread; // small id in the order threads first recorded
+};
+
+char const *trace_event_name(trace_event_type type);
+
+/* -------------------------------------------------------------------------- */
+/*                                  policies                                  */
+/* -------------------------------------------------------------------------- */
+/*
+  The containers report to trace_policy, chosen when compiling with
+  FT_TRACE_POLICY. The default does nothing and compiles away, hooks only
+  pass values the container already has at hand.
+*/
+struct null_trace {
+  static bool const enabled = false;
+
+  static void record(trace_event_type, std::size_t) {}
+
+  static bool dump(char const *) { return false; }
+};
+
+/*
+  Keeps the last FT_TRACE_CAPACITY events in a ring buffer, older ones are
+  overwritten. Any thread may record, a slot is claimed with one atomic
+  increment; read and dump are only consistent when nobody records. The
+  events are stored inline, about 1.5 MiB with the default capacity, so
+  rings belong in static storage or on the heap.
+
+  dump writes the header below followed by the events, oldest first.
+*/
+class trace_ring {
+public:
+  struct header {
+    char magic[8]; // "FTTRACE\0"
+    uint32_t version;
+    uint32_t event_size;
+    uint64_t count; // events that follow
+    uint64_t dropped; // overwritten before the dump
+  };
+
+private:
+  trace_event _m_events[FT_TRACE_CAPACITY];
+  std::size_t _m_next;
+
+  trace_ring(trace_ring const &);
+  trace_ring &operator=(trace_ring const &);
+
+public:
+  trace_ring() : _m_next(0) {}
+
+  void record(trace_event_type type, std::size_t size);
+  // events recorded since the last clear, dropped ones included
+  std::size_t recorded() const;
+  // copies up to n of the most recent events, oldest first
+  std::size_t read(trace_event *out, std::size_t n) const;
+  void clear();
+  bool dump(char const *path) const;
+};
+
+// records to the ring of the process, the one --trace dumps
+struct ring_trace {
+  static bool const enabled = true;
+
+  static trace_ring &ring();
+  static void record(trace_event_type type, std::size_t size);
+  static bool dump(char const *path);
+};
+
+#ifndef FT_TRACE_POLICY
+#define FT_TRACE_POLICY null_trace
+#endif
+
+typedef FT_TRACE_POLICY trace_policy;
+} // namespace ft
+
+#endif
@@ -1,5 +1,11 @@
 #include "tree.hpp"
 
+#ifdef FT_TREE_STATS
+#define FT_TREE_COUNT(counter) (++Rb_tree_global_counters().counter)
+#else
+#define FT_TREE_COUNT(counter) ((void)0)
+#endif
+
 namespace ft {
 Rb_tree_node_base *Rb_tree_node_base::min(Rb_tree_node_base *x) {
   while (x->_m_left != NULL) {
@@ -29,7 +35,10 @@ Rb_tree_node_base const *Rb_tree_node_base::max(Rb_tree_node_base const *x) {
   return x;
 }
 
-void Rb_tree_rotate_left(Rb_tree_node_base *const x, Rb_tree_node_base *&root) {
+// x goes down under y, so its cached value is recomputed first
+void Rb_tree_rotate_left(Rb_tree_node_base *const x, Rb_tree_node_base *&root,
+                         Rb_tree_augment_fn augment) {
+  FT_TREE_COUNT(rotations);
   Rb_tree_node_base *const y = x->_m_right;
 
   x->_m_right = y->_m_left;
@@ -47,10 +56,15 @@ void Rb_tree_rotate_left(Rb_tree_node_base *const x, Rb_tree_node_base *&root) {
   }
   y->_m_left = x;
   x->_m_parent = y;
+  if (augment != NULL) {
+    augment(x);
+    augment(y);
+  }
 }
 
-void Rb_tree_rotate_right(Rb_tree_node_base *const x,
-                          Rb_tree_node_base *&root) {
+void Rb_tree_rotate_right(Rb_tree_node_base *const x, Rb_tree_node_base *&root,
+                          Rb_tree_augment_fn augment) {
+  FT_TREE_COUNT(rotations);
   Rb_tree_node_base *const y = x->_m_left;
 
   x->_m_left = y->_m_right;
@@ -68,17 +82,42 @@ void Rb_tree_rotate_right(Rb_tree_node_base *const x,
   }
   y->_m_right = x;
   x->_m_parent = y;
+  if (augment != NULL) {
+    augment(x);
+    augment(y);
+  }
+}
+
+// from x up to the root, after the subtree under x changed
+static void Rb_tree_augment_path(Rb_tree_node_base *x,
+                                 Rb_tree_node_base const &header,
+                                 Rb_tree_augment_fn augment) {
+  if (augment != NULL) {
+    for (; x != &header; x = x->_m_parent) {
+      augment(x);
+    }
+  }
 }
 
 void Rb_tree_insert_and_rebalance(bool const insert_left, Rb_tree_node_base *x,
                                   Rb_tree_node_base *p,
-                                  Rb_tree_node_base &header) {
+                                  Rb_tree_node_base &header,
+                                  Rb_tree_augment_fn augment) {
   Rb_tree_node_base *&root = header._m_parent;
+  FT_TREE_COUNT(insert_rebalances);
 
   x->_m_parent = p;
   x->_m_left = NULL;
   x->_m_right = NULL;
   x->_m_color = RBT_RED;
+#ifdef FT_TREE_THREADED
+  // a new left child comes right before its parent, a right one right after
+  Rb_tree_node_base *const next = insert_left ? p : p->_m_next;
+  x->_m_prev = next->_m_prev;
+  x->_m_next = next;
+  x->_m_prev->_m_next = x;
+  next->_m_prev = x;
+#endif
 
   if (insert_left) {
     p->_m_left = x;
@@ -93,8 +132,11 @@ void Rb_tree_insert_and_rebalance(bool const insert_left, Rb_tree_node_base *x,
       header._m_right = x;
     }
   }
+  Rb_tree_augment_path(x, header, augment);
+  std::size_t steps = 0;
   while (x != root && x->_m_parent->_m_color == RBT_RED) {
     Rb_tree_node_base *const xpp = x->_m_parent->_m_parent;
+    ++steps;
 
     if (x->_m_parent == xpp->_m_left) {
       Rb_tree_node_base *const y = xpp->_m_right;
@@ -106,11 +148,11 @@ void Rb_tree_insert_and_rebalance(bool const insert_left, Rb_tree_node_base *x,
       } else {
         if (x == x->_m_parent->_m_right) {
           x = x->_m_parent;
-          Rb_tree_rotate_left(x, root);
+          Rb_tree_rotate_left(x, root, augment);
         }
         x->_m_parent->_m_color = RBT_BLACK;
         xpp->_m_color = RBT_RED;
-        Rb_tree_rotate_right(xpp, root);
+        Rb_tree_rotate_right(xpp, root, augment);
       }
     } else {
       Rb_tree_node_base *const y = xpp->_m_left;
@@ -122,25 +164,32 @@ void Rb_tree_insert_and_rebalance(bool const insert_left, Rb_tree_node_base *x,
       } else {
         if (x == x->_m_parent->_m_left) {
           x = x->_m_parent;
-          Rb_tree_rotate_right(x, root);
+          Rb_tree_rotate_right(x, root, augment);
         }
         x->_m_parent->_m_color = RBT_BLACK;
         xpp->_m_color = RBT_RED;
-        Rb_tree_rotate_left(xpp, root);
+        Rb_tree_rotate_left(xpp, root, augment);
       }
     }
   }
   root->_m_color = RBT_BLACK;
+  trace_policy::record(TRACE_INSERT_REBALANCE, steps);
 }
 
 Rb_tree_node_base *Rb_tree_rebalance_for_erase(Rb_tree_node_base *const z,
-                                               Rb_tree_node_base &header) {
+                                               Rb_tree_node_base &header,
+                                               Rb_tree_augment_fn augment) {
   Rb_tree_node_base *&root = header._m_parent;
   Rb_tree_node_base *&leftmost = header._m_left;
   Rb_tree_node_base *&rightmost = header._m_right;
   Rb_tree_node_base *y = z;
   Rb_tree_node_base *x = NULL;
   Rb_tree_node_base *x_parent = NULL;
+  FT_TREE_COUNT(erase_rebalances);
+#ifdef FT_TREE_THREADED
+  z->_m_prev->_m_next = z->_m_next;
+  z->_m_next->_m_prev = z->_m_prev;
+#endif
 
   if (y->_m_left == NULL) {
     x = y->_m_right;
@@ -204,14 +253,18 @@ Rb_tree_node_base *Rb_tree_rebalance_for_erase(Rb_tree_node_base *const z,
       }
     }
   }
+  // x_parent is the lowest node whose subtree lost a node
+  Rb_tree_augment_path(x_parent, header, augment);
+  std::size_t steps = 0;
   if (y->_m_color != RBT_RED) {
     while (x != root && (x == NULL || x->_m_color == RBT_BLACK)) {
+      ++steps;
       if (x == x_parent->_m_left) {
         Rb_tree_node_base *w = x_parent->_m_right;
         if (w->_m_color == RBT_RED) {
           w->_m_color = RBT_BLACK;
           x_parent->_m_color = RBT_RED;
-          Rb_tree_rotate_left(x_parent, root);
+          Rb_tree_rotate_left(x_parent, root, augment);
           w = x_parent->_m_right;
         }
         if ((w->_m_left == NULL || w->_m_left->_m_color == RBT_BLACK) &&
@@ -223,7 +276,7 @@ Rb_tree_node_base *Rb_tree_rebalance_for_erase(Rb_tree_node_base *const z,
           if (w->_m_right == NULL || w->_m_right->_m_color == RBT_BLACK) {
             w->_m_left->_m_color = RBT_BLACK;
             w->_m_color = RBT_RED;
-            Rb_tree_rotate_right(w, root);
+            Rb_tree_rotate_right(w, root, augment);
             w = x_parent->_m_right;
           }
           w->_m_color = x_parent->_m_color;
@@ -231,7 +284,7 @@ Rb_tree_node_base *Rb_tree_rebalance_for_erase(Rb_tree_node_base *const z,
           if (w->_m_right) {
             w->_m_right->_m_color = RBT_BLACK;
           }
-          Rb_tree_rotate_left(x_parent, root);
+          Rb_tree_rotate_left(x_parent, root, augment);
           break;
         }
       } else {
@@ -239,7 +292,7 @@ Rb_tree_node_base *Rb_tree_rebalance_for_erase(Rb_tree_node_base *const z,
         if (w->_m_color == RBT_RED) {
           w->_m_color = RBT_BLACK;
           x_parent->_m_color = RBT_RED;
-          Rb_tree_rotate_right(x_parent, root);
+          Rb_tree_rotate_right(x_parent, root, augment);
           w = x_parent->_m_left;
         }
         if ((w->_m_right == NULL || w->_m_right->_m_color == RBT_BLACK) &&
@@ -251,7 +304,7 @@ Rb_tree_node_base *Rb_tree_rebalance_for_erase(Rb_tree_node_base *const z,
           if (w->_m_left == NULL || w->_m_left->_m_color == RBT_BLACK) {
             w->_m_right->_m_color = RBT_BLACK;
             w->_m_color = RBT_RED;
-            Rb_tree_rotate_left(w, root);
+            Rb_tree_rotate_left(w, root, augment);
             w = x_parent->_m_left;
           }
           w->_m_color = x_parent->_m_color;
@@ -259,7 +312,7 @@ Rb_tree_node_base *Rb_tree_rebalance_for_erase(Rb_tree_node_base *const z,
           if (w->_m_left) {
             w->_m_left->_m_color = RBT_BLACK;
           }
-          Rb_tree_rotate_right(x_parent, root);
+          Rb_tree_rotate_right(x_parent, root, augment);
           break;
         }
       }
@@ -268,6 +321,7 @@ Rb_tree_node_base *Rb_tree_rebalance_for_erase(Rb_tree_node_base *const z,
       x->_m_color = RBT_BLACK;
     }
   }
+  trace_policy::record(TRACE_ERASE_REBALANCE, steps);
   return y;
 }
 
@@ -316,4 +370,104 @@ Rb_tree_node_base *Rb_tree_node_decrement(Rb_tree_node_base *node) {
 Rb_tree_node_base const *Rb_tree_node_decrement(Rb_tree_node_base const *node) {
   return Rb_tree_node_decrement(const_cast<Rb_tree_node_base *>(node));
 }
+
+/* -------------------------------------------------------------------------- */
+/*                                  threading                                 */
+/* -------------------------------------------------------------------------- */
+#ifdef FT_TREE_THREADED
+void Rb_tree_relink_header(Rb_tree_node_base &header) {
+  if (header._m_parent == NULL) {
+    header._m_next = &header;
+    header._m_prev = &header;
+    return;
+  }
+  header._m_next = header._m_left;
+  header._m_left->_m_prev = &header;
+  header._m_prev = header._m_right;
+  header._m_right->_m_next = &header;
+}
+
+// follows the parent links, the only order a fresh copy has
+void Rb_tree_rethread(Rb_tree_node_base &header) {
+  Rb_tree_node_base *prev = &header;
+  if (header._m_parent != NULL) {
+    for (Rb_tree_node_base *x = header._m_left; x != &header;
+         x = Rb_tree_node_increment(x)) {
+      prev->_m_next = x;
+      x->_m_prev = prev;
+      prev = x;
+    }
+  }
+  prev->_m_next = &header;
+  header._m_prev = prev;
+}
+#else
+void Rb_tree_relink_header(Rb_tree_node_base &) {}
+
+void Rb_tree_rethread(Rb_tree_node_base &) {}
+#endif
+
+/* -------------------------------------------------------------------------- */
+/*                                augmentation                                */
+/* -------------------------------------------------------------------------- */
+// children first, as a freshly copied tree has no cached values yet
+void Rb_tree_augment_all(Rb_tree_node_base *x, Rb_tree_augment_fn augment) {
+  if (augment == NULL || x == NULL) {
+    return;
+  }
+  Rb_tree_augment_all(x->_m_left, augment);
+  Rb_tree_augment_all(x->_m_right, augment);
+  augment(x);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                 statistics                                 */
+/* -------------------------------------------------------------------------- */
+/*
+  Depth first walk, depth and blacks count the nodes above x. The recursion
+  is bounded by the height of the tree, 2 log2(n + 1) at most.
+*/
+static void Rb_tree_walk(Rb_tree_node_base const *x, std::size_t depth,
+                         std::size_t blacks, Rb_tree_stats &stats,
+                         double &node_depths, double &null_depths) {
+  if (x == NULL) {
+    null_depths += depth;
+    if (stats.black_height == 0) {
+      stats.black_height = blacks;
+    }
+    return;
+  }
+  ++depth;
+  blacks += x->_m_color == RBT_BLACK;
+  ++stats.size;
+  node_depths += depth;
+  stats.height = std::max(stats.height, depth);
+  Rb_tree_walk(x->_m_left, depth, blacks, stats, node_depths, null_depths);
+  Rb_tree_walk(x->_m_right, depth, blacks, stats, node_depths, null_depths);
+}
+
+Rb_tree_stats Rb_tree_compute_stats(Rb_tree_node_base const *root) {
+  Rb_tree_stats stats = Rb_tree_stats();
+  double node_depths = 0;
+  double null_depths = 0;
+  Rb_tree_walk(root, 0, 0, stats, node_depths, null_depths);
+  if (stats.size > 0) {
+    stats.average_depth = node_depths / stats.size;
+  }
+  stats.average_search_depth = null_depths / (stats.size + 1);
+  return stats;
+}
+
+bool Rb_tree_counters_enabled() {
+#ifdef FT_TREE_STATS
+  return true;
+#else
+  return false;
+#endif
+}
+
+Rb_tree_counters &Rb_tree_global_counters() {
+  static Rb_tree_counters counters = Rb_tree_counters();
+  return counters;
+}
 } // namespace ft
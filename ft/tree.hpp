@@ -2,7 +2,9 @@
 #define TREE_HPP
 
 #include "algorithm.hpp"
+#include "allocator.hpp"
 #include "iterator.hpp"
+#include "trace.hpp"
 #include "utility.hpp"
 
 #include <algorithm>
@@ -17,6 +19,13 @@ enum _E_Rb_tree_node_color { RBT_RED, RBT_BLACK };
 /* -------------------------------------------------------------------------- */
 /*                               tree node base                               */
 /* -------------------------------------------------------------------------- */
+/*
+  With FT_TREE_THREADED every node also links to its neighbours in key
+  order, the header coming before the first node and after the last one.
+  Rotations keep the order, so only inserts and erases relink, and iterators
+  move with a single load instead of climbing parent links. Costs two
+  pointers per node.
+*/
 struct Rb_tree_node_base {
   typedef Rb_tree_node_base *_t_base_ptr;
   typedef Rb_tree_node_base const *_t_const_base_ptr;
@@ -25,6 +34,10 @@ struct Rb_tree_node_base {
   _t_base_ptr _m_parent;
   _t_base_ptr _m_left;
   _t_base_ptr _m_right;
+#ifdef FT_TREE_THREADED
+  _t_base_ptr _m_prev;
+  _t_base_ptr _m_next;
+#endif
 
   static _t_base_ptr min(_t_base_ptr x);
 
@@ -35,12 +48,25 @@ struct Rb_tree_node_base {
   static _t_const_base_ptr max(_t_const_base_ptr x);
 };
 
+/*
+  Augmented trees cache in every node a value computed from the node and its
+  children, as the largest bound of an interval subtree. The callback
+  recomputes it for one node whose children are up to date; the rebalancing
+  functions call it up the path of an insert or erase and on both nodes of
+  every rotation, so the cache is right once they return. NULL for plain
+  trees.
+*/
+typedef void (*Rb_tree_augment_fn)(Rb_tree_node_base *x);
+
 /* -------------------------------------------------------------------------- */
 /*                                  tree node                                 */
 /* -------------------------------------------------------------------------- */
 template <typename _T_Val> struct Rb_tree_node : public Rb_tree_node_base {
   typedef Rb_tree_node<_T_Val> *_t_node_ptr;
   _T_Val _m_value;
+
+  // nodes of augmented trees derive from this one and hide it
+  static Rb_tree_augment_fn augment() { return NULL; }
 };
 
 /* -------------------------------------------------------------------------- */
@@ -54,12 +80,94 @@ Rb_tree_node_base *Rb_tree_node_decrement(Rb_tree_node_base *x);
 
 Rb_tree_node_base const *Rb_tree_node_decrement(Rb_tree_node_base const *x);
 
+// what the iterators use, the links of a threaded tree or the climb
+inline Rb_tree_node_base *Rb_tree_next(Rb_tree_node_base *x) {
+#ifdef FT_TREE_THREADED
+  return x->_m_next;
+#else
+  return Rb_tree_node_increment(x);
+#endif
+}
+
+inline Rb_tree_node_base const *Rb_tree_next(Rb_tree_node_base const *x) {
+#ifdef FT_TREE_THREADED
+  return x->_m_next;
+#else
+  return Rb_tree_node_increment(x);
+#endif
+}
+
+inline Rb_tree_node_base *Rb_tree_prev(Rb_tree_node_base *x) {
+#ifdef FT_TREE_THREADED
+  return x->_m_prev;
+#else
+  return Rb_tree_node_decrement(x);
+#endif
+}
+
+inline Rb_tree_node_base const *Rb_tree_prev(Rb_tree_node_base const *x) {
+#ifdef FT_TREE_THREADED
+  return x->_m_prev;
+#else
+  return Rb_tree_node_decrement(x);
+#endif
+}
+
+/*
+  Threaded trees only, no-ops otherwise. relink_header points the header and
+  the first and last nodes at each other, after the header changed hands as
+  in swap or clear. rethread relinks every node, after a copy.
+*/
+void Rb_tree_relink_header(Rb_tree_node_base &header);
+
+void Rb_tree_rethread(Rb_tree_node_base &header);
+
 void Rb_tree_insert_and_rebalance(bool const insert_left, Rb_tree_node_base *x,
                                   Rb_tree_node_base *p,
-                                  Rb_tree_node_base &header);
+                                  Rb_tree_node_base &header,
+                                  Rb_tree_augment_fn augment = NULL);
+
+Rb_tree_node_base *
+Rb_tree_rebalance_for_erase(Rb_tree_node_base *const z,
+                            Rb_tree_node_base &header,
+                            Rb_tree_augment_fn augment = NULL);
+
+// recomputes every cached value of the subtree, after a copy
+void Rb_tree_augment_all(Rb_tree_node_base *x, Rb_tree_augment_fn augment);
+
+/* -------------------------------------------------------------------------- */
+/*                                 statistics                                 */
+/* -------------------------------------------------------------------------- */
+/*
+  Shape of a tree. Depths count the nodes on the path from the root, the root
+  is at depth 1 and the height is the deepest node. A lookup walks from the
+  root down to a null link with one comparison per node, average_search_depth
+  is the length of that walk averaged over the size + 1 null links.
+*/
+struct Rb_tree_stats {
+  std::size_t size;
+  std::size_t height;
+  std::size_t black_height;
+  double average_depth;
+  double average_search_depth;
+};
+
+Rb_tree_stats Rb_tree_compute_stats(Rb_tree_node_base const *root);
+
+/*
+  Rebalancing work of all the trees of the program, only counted when
+  tree.cpp is built with FT_TREE_STATS, see Rb_tree_counters_enabled. Plain
+  counters: concurrent writers to different trees lose increments.
+*/
+struct Rb_tree_counters {
+  unsigned long insert_rebalances;
+  unsigned long erase_rebalances;
+  unsigned long rotations;
+};
+
+bool Rb_tree_counters_enabled();
 
-Rb_tree_node_base *Rb_tree_rebalance_for_erase(Rb_tree_node_base *const z,
-                                               Rb_tree_node_base &header);
+Rb_tree_counters &Rb_tree_global_counters();
 
 /* -------------------------------------------------------------------------- */
 /*                                  iterator                                  */
@@ -91,24 +199,24 @@ template <typename _T_Val> struct Rb_tree_iterator {
   }
 
   _t_self &operator++() {
-    _m_node = Rb_tree_node_increment(_m_node);
+    _m_node = Rb_tree_next(_m_node);
     return *this;
   }
 
   _t_self operator++(int) {
     _t_self tmp = *this;
-    _m_node = Rb_tree_node_increment(_m_node);
+    _m_node = Rb_tree_next(_m_node);
     return tmp;
   }
 
   _t_self &operator--() {
-    _m_node = Rb_tree_node_decrement(_m_node);
+    _m_node = Rb_tree_prev(_m_node);
     return *this;
   }
 
   _t_self operator--(int) {
     _t_self tmp = *this;
-    _m_node = Rb_tree_node_decrement(_m_node);
+    _m_node = Rb_tree_prev(_m_node);
     return tmp;
   }
 
@@ -155,24 +263,24 @@ template <typename _T_Val> struct Rb_tree_const_iterator {
   }
 
   _t_self &operator++() {
-    _m_node = Rb_tree_node_increment(_m_node);
+    _m_node = Rb_tree_next(_m_node);
     return *this;
   }
 
   _t_self operator++(int) {
     _t_self tmp = *this;
-    _m_node = Rb_tree_node_increment(_m_node);
+    _m_node = Rb_tree_next(_m_node);
     return tmp;
   }
 
   _t_self &operator--() {
-    _m_node = Rb_tree_node_decrement(_m_node);
+    _m_node = Rb_tree_prev(_m_node);
     return *this;
   }
 
   _t_self operator--(int) {
     _t_self tmp = *this;
-    _m_node = Rb_tree_node_decrement(_m_node);
+    _m_node = Rb_tree_prev(_m_node);
     return tmp;
   }
 
@@ -188,15 +296,21 @@ template <typename _T_Val> struct Rb_tree_const_iterator {
 /* -------------------------------------------------------------------------- */
 /*                                    tree                                    */
 /* -------------------------------------------------------------------------- */
+/*
+  _T_Node is the node actually allocated, an augmented tree passes a type
+  derived from Rb_tree_node<_T_Val> with its own augment(), see
+  Rb_tree_augment_fn.
+*/
 template <typename _T_Key, typename _T_Val, typename _T_KeyOfValue,
-          typename _T_Compare, typename _T_Alloc = std::allocator<_T_Val> >
+          typename _T_Compare, typename _T_Alloc = std::allocator<_T_Val>,
+          typename _T_Node = Rb_tree_node<_T_Val> >
 class Rb_tree {
 
   /* -------------------------------- typedef ------------------------------- */
-  typedef typename _T_Alloc::template rebind<Rb_tree_node<_T_Val> >::other
-      _t_node_allocator;
+  typedef typename _T_Alloc::template rebind<_T_Node>::other _t_node_allocator;
 
-  typedef Rb_tree<_T_Key, _T_Val, _T_KeyOfValue, _T_Compare, _T_Alloc> _t_self;
+  typedef Rb_tree<_T_Key, _T_Val, _T_KeyOfValue, _T_Compare, _T_Alloc, _T_Node>
+      _t_self;
   typedef Rb_tree_node_base *_t_base_ptr;
   typedef Rb_tree_node_base const *_t_const_base_ptr;
   typedef Rb_tree_node<_T_Val> Rb_tree_node;
@@ -225,11 +339,13 @@ public:
 
 protected:
   Rb_tree_node *_allocate_node() {
+    trace_policy::record(TRACE_NODE_ALLOCATE, sizeof(_T_Node));
     return this->_m_impl._t_node_allocator::allocate(1);
   }
 
   void _deallocate_node(Rb_tree_node *p) {
-    this->_m_impl._t_node_allocator::deallocate(p, 1);
+    trace_policy::record(TRACE_NODE_DEALLOCATE, sizeof(_T_Node));
+    this->_m_impl._t_node_allocator::deallocate(static_cast<_T_Node *>(p), 1);
   }
 
   _t_node_ptr _construct_node(const value_type &x) {
@@ -243,6 +359,17 @@ protected:
     return tmp;
   }
 
+  template <typename _T_Ctor> _t_node_ptr _emplace_node(_T_Ctor const &ctor) {
+    _t_node_ptr tmp = _allocate_node();
+    try {
+      ctor(&tmp->_m_value);
+    } catch (...) {
+      _deallocate_node(tmp);
+      throw;
+    }
+    return tmp;
+  }
+
   _t_node_ptr _clone_node(_t_const_node_ptr x) {
     _t_node_ptr tmp = _construct_node(x->_m_value);
     tmp->_m_color = x->_m_color;
@@ -270,6 +397,7 @@ protected:
       this->_m_header._m_parent = NULL;
       this->_m_header._m_left = &this->_m_header;
       this->_m_header._m_right = &this->_m_header;
+      Rb_tree_relink_header(this->_m_header);
     }
   };
 
@@ -366,6 +494,8 @@ public:
       _root() = _copy(x._begin(), _end());
       _leftmost() = _min(_root());
       _rightmost() = _max(_root());
+      Rb_tree_rethread(this->_m_impl._m_header);
+      Rb_tree_augment_all(_root(), _T_Node::augment());
       this->_m_impl._m_node_count = x._m_impl._m_node_count;
     }
   }
@@ -382,6 +512,8 @@ public:
         _root() = _copy(x._begin(), _end());
         _leftmost() = _min(_root());
         _rightmost() = _max(_root());
+        Rb_tree_rethread(this->_m_impl._m_header);
+        Rb_tree_augment_all(_root(), _T_Node::augment());
         this->_m_impl._m_node_count = x._m_impl._m_node_count;
       }
     }
@@ -428,18 +560,95 @@ public:
                                std::numeric_limits<difference_type>::max());
   }
 
+  /* ----------------------------- introspection ---------------------------- */
+  // walks the whole tree, O(n)
+  Rb_tree_stats stats() const { return Rb_tree_compute_stats(_root()); }
+
+  // for the containers that search the nodes themselves, as interval_map
+  _t_const_base_ptr root() const { return _root(); }
+
   /* ------------------------------- modifier ------------------------------- */
 private:
   iterator _insert(_t_base_ptr x, _t_base_ptr y, value_type const &v) {
+    return _insert_node(x, y, _construct_node(v));
+  }
+
+  iterator _insert_node(_t_base_ptr x, _t_base_ptr y, _t_node_ptr z) {
     bool insert_left =
         (x != NULL || y == _end() ||
-         this->_m_impl._m_key_compare(_T_KeyOfValue()(v), _node_key(y)));
-    _t_node_ptr z = _construct_node(v);
-    Rb_tree_insert_and_rebalance(insert_left, z, y, this->_m_impl._m_header);
+         this->_m_impl._m_key_compare(_node_key(z), _node_key(y)));
+    Rb_tree_insert_and_rebalance(insert_left, z, y, this->_m_impl._m_header,
+                                 _T_Node::augment());
     ++this->_m_impl._m_node_count;
     return iterator(z);
   }
 
+  /*
+    Returns the (x, y) pair expected by _insert, or (node, NULL) when a node
+    with an equivalent key is already in the tree.
+  */
+  pair<_t_base_ptr, _t_base_ptr> _get_insert_unique_pos(key_type const &k) {
+    _t_node_ptr x = _begin();
+    _t_node_ptr y = _end();
+    bool comp = true;
+    while (x != NULL) {
+      y = x;
+      comp = this->_m_impl._m_key_compare(k, _node_key(x));
+      x = comp ? _left(x) : _right(x);
+    }
+    iterator j = iterator(y);
+    if (comp) {
+      if (j == begin()) {
+        return pair<_t_base_ptr, _t_base_ptr>(x, y);
+      } else {
+        --j;
+      }
+    }
+    if (this->_m_impl._m_key_compare(_node_key(j._m_node), k)) {
+      return pair<_t_base_ptr, _t_base_ptr>(x, y);
+    }
+    return pair<_t_base_ptr, _t_base_ptr>(j._m_node, NULL);
+  }
+
+  pair<_t_base_ptr, _t_base_ptr>
+  _get_insert_hint_unique_pos(iterator position, key_type const &k) {
+    typedef pair<_t_base_ptr, _t_base_ptr> _t_res;
+    if (position._m_node == _end()) {
+      if (size() > 0 &&
+          this->_m_impl._m_key_compare(_node_key(_rightmost()), k)) {
+        return _t_res(NULL, _rightmost());
+      }
+      return _get_insert_unique_pos(k);
+    }
+    if (this->_m_impl._m_key_compare(k, _node_key(position._m_node))) {
+      iterator before = position;
+      if (position._m_node == _leftmost()) {
+        return _t_res(_leftmost(), _leftmost());
+      }
+      if (this->_m_impl._m_key_compare(_node_key((--before)._m_node), k)) {
+        if (_right(before._m_node) == NULL) {
+          return _t_res(NULL, before._m_node);
+        }
+        return _t_res(position._m_node, position._m_node);
+      }
+      return _get_insert_unique_pos(k);
+    }
+    if (this->_m_impl._m_key_compare(_node_key(position._m_node), k)) {
+      iterator after = position;
+      if (position._m_node == _rightmost()) {
+        return _t_res(NULL, _rightmost());
+      }
+      if (this->_m_impl._m_key_compare(k, _node_key((++after)._m_node))) {
+        if (_right(position._m_node) == NULL) {
+          return _t_res(NULL, position._m_node);
+        }
+        return _t_res(after._m_node, after._m_node);
+      }
+      return _get_insert_unique_pos(k);
+    }
+    return _t_res(position._m_node, NULL);
+  }
+
   _t_node_ptr _copy(_t_const_node_ptr x, _t_node_ptr p) {
     _t_node_ptr top = _clone_node(x);
     top->_m_parent = p;
@@ -477,68 +686,59 @@ private:
 
 public:
   pair<iterator, bool> insert(value_type const &v) {
-    _t_node_ptr x = _begin();
-    _t_node_ptr y = _end();
-    bool comp = true;
-    while (x != NULL) {
-      y = x;
-      comp = this->_m_impl._m_key_compare(_T_KeyOfValue()(v), _node_key(x));
-      x = comp ? _left(x) : _right(x);
+    pair<_t_base_ptr, _t_base_ptr> res =
+        _get_insert_unique_pos(_T_KeyOfValue()(v));
+    if (res.second != NULL) {
+      return pair<iterator, bool>(_insert(res.first, res.second, v), true);
     }
-    iterator j = iterator(y);
-    if (comp) {
-      if (j == begin()) {
-        return pair<iterator, bool>(_insert(x, y, v), true);
-      } else {
-        --j;
-      }
-    }
-    if (this->_m_impl._m_key_compare(_node_key(j._m_node),
-                                     _T_KeyOfValue()(v))) {
-      return pair<iterator, bool>(_insert(x, y, v), true);
-    }
-    return pair<iterator, bool>(j, false);
+    return pair<iterator, bool>(static_cast<_t_node_ptr>(res.first), false);
   }
 
   iterator insert(iterator position, value_type const &v) {
-    if (position._m_node == _end()) {
-      if (size() > 0 && this->_m_impl._m_key_compare(_node_key(_rightmost()),
-                                                     _T_KeyOfValue()(v))) {
-        return _insert(0, _rightmost(), v);
-      }
-      return insert(v).first;
+    pair<_t_base_ptr, _t_base_ptr> res =
+        _get_insert_hint_unique_pos(position, _T_KeyOfValue()(v));
+    if (res.second != NULL) {
+      return _insert(res.first, res.second, v);
     }
-    if (this->_m_impl._m_key_compare(_T_KeyOfValue()(v),
-                                     _node_key(position._m_node))) {
-      iterator before = position;
-      if (position._m_node == _leftmost()) {
-        return _insert(_leftmost(), _leftmost(), v);
-      }
-      if (this->_m_impl._m_key_compare(_node_key((--before)._m_node),
-                                       _T_KeyOfValue()(v))) {
-        if (_right(before._m_node) == NULL) {
-          return _insert(0, before._m_node, v);
-        }
-        return _insert(position._m_node, position._m_node, v);
-      }
-      return insert(v).first;
+    return static_cast<_t_node_ptr>(res.first);
+  }
+
+  /*
+    The node is built before looking for its position since the key is only
+    known once the value exists, it is destroyed if the key is already there.
+  */
+  template <typename _T_Ctor>
+  pair<iterator, bool> emplace_unique(_T_Ctor const &ctor) {
+    _t_node_ptr z = _emplace_node(ctor);
+    pair<_t_base_ptr, _t_base_ptr> res;
+    try {
+      res = _get_insert_unique_pos(_node_key(z));
+    } catch (...) {
+      _destroy_node(z);
+      throw;
     }
-    if (this->_m_impl._m_key_compare(_node_key(position._m_node),
-                                     _T_KeyOfValue()(v))) {
-      iterator after = position;
-      if (position._m_node == _rightmost()) {
-        return _insert(0, _rightmost(), v);
-      }
-      if (this->_m_impl._m_key_compare(_T_KeyOfValue()(v),
-                                       _node_key((++after)._m_node))) {
-        if (_right(position._m_node) == NULL) {
-          return _insert(0, position._m_node, v);
-        }
-        return _insert(after._m_node, after._m_node, v);
-      }
-      return insert(v).first;
+    if (res.second != NULL) {
+      return pair<iterator, bool>(_insert_node(res.first, res.second, z), true);
+    }
+    _destroy_node(z);
+    return pair<iterator, bool>(static_cast<_t_node_ptr>(res.first), false);
+  }
+
+  template <typename _T_Ctor>
+  iterator emplace_hint_unique(iterator position, _T_Ctor const &ctor) {
+    _t_node_ptr z = _emplace_node(ctor);
+    pair<_t_base_ptr, _t_base_ptr> res;
+    try {
+      res = _get_insert_hint_unique_pos(position, _node_key(z));
+    } catch (...) {
+      _destroy_node(z);
+      throw;
+    }
+    if (res.second != NULL) {
+      return _insert_node(res.first, res.second, z);
     }
-    return position;
+    _destroy_node(z);
+    return static_cast<_t_node_ptr>(res.first);
   }
 
   template <typename _T_InputIterator>
@@ -549,8 +749,8 @@ public:
   }
 
   void erase(iterator position) {
-    _t_node_ptr y = static_cast<_t_node_ptr>(
-        Rb_tree_rebalance_for_erase(position._m_node, this->_m_impl._m_header));
+    _t_node_ptr y = static_cast<_t_node_ptr>(Rb_tree_rebalance_for_erase(
+        position._m_node, this->_m_impl._m_header, _T_Node::augment()));
     _destroy_node(y);
     --this->_m_impl._m_node_count;
   }
@@ -577,6 +777,7 @@ public:
     _leftmost() = _end();
     _root() = NULL;
     _rightmost() = _end();
+    Rb_tree_relink_header(this->_m_impl._m_header);
     this->_m_impl._m_node_count = 0;
   }
 
@@ -606,6 +807,8 @@ public:
       _root()->_m_parent = _end();
       t._root()->_m_parent = t._end();
     }
+    Rb_tree_relink_header(this->_m_impl._m_header);
+    Rb_tree_relink_header(t._m_impl._m_header);
     std::swap(this->_m_impl._m_node_count, t._m_impl._m_node_count);
     std::swap(this->_m_impl._m_key_compare, t._m_impl._m_key_compare);
   }
@@ -48,6 +48,14 @@ template <> struct is_integral<char> {
   enum { value = 1 };
 };
 
+template <> struct is_integral<signed char> {
+  enum { value = 1 };
+};
+
+template <> struct is_integral<unsigned char> {
+  enum { value = 1 };
+};
+
 template <> struct is_integral<wchar_t> {
   enum { value = 1 };
 };
@@ -56,14 +64,26 @@ template <> struct is_integral<short> {
   enum { value = 1 };
 };
 
+template <> struct is_integral<unsigned short> {
+  enum { value = 1 };
+};
+
 template <> struct is_integral<int> {
   enum { value = 1 };
 };
 
+template <> struct is_integral<unsigned int> {
+  enum { value = 1 };
+};
+
 template <> struct is_integral<long> {
   enum { value = 1 };
 };
 
+template <> struct is_integral<unsigned long> {
+  enum { value = 1 };
+};
+
 template <> struct is_integral<long long> {
   enum { value = 1 };
 };
@@ -101,6 +121,29 @@ template <> struct is_floating<long double> {
 template <typename T>
 struct is_arithmetic : public traitor<is_integral<T>, is_floating<T> > {};
 
+/* -------------------------------------------------------------------------- */
+/*                                 is pointer                                 */
+/* -------------------------------------------------------------------------- */
+template <typename T> struct is_pointer {
+  enum { value = 0 };
+  typedef false_type type;
+};
+
+template <typename T> struct is_pointer<T *> {
+  enum { value = 1 };
+  typedef true_type type;
+};
+
+/* -------------------------------------------------------------------------- */
+/*                                  is scalar                                 */
+/* -------------------------------------------------------------------------- */
+/*
+  Scalar types have no constructor nor destructor, an uninitialized object of
+  such a type can be overwritten byte per byte without any other bookkeeping.
+*/
+template <typename T>
+struct is_scalar : public traitor<is_arithmetic<T>, is_pointer<T> > {};
+
 /* -------------------------------------------------------------------------- */
 /*                                are same type                               */
 /* -------------------------------------------------------------------------- */
@@ -1,8 +1,10 @@
 #ifndef VECTOR_HPP
 #define VECTOR_HPP
 
+#include "algorithm.hpp"
 #include "allocator.hpp"
 #include "iterator.hpp"
+#include "trace.hpp"
 #include "type_traits.hpp"
 
 #include <algorithm>
@@ -142,8 +144,7 @@ public:
       size_type const len = x.size();
       if (len > capacity()) {
         pointer tmp = _allocate_and_copy(len, x.begin(), x.end());
-        _destroy_deallocate_set(tmp, tmp + len,
-                                this->_m_impl._m_end_of_storage);
+        _destroy_deallocate_set(tmp, tmp + len, tmp + len);
       } else if (size() >= len) {
         iterator i(std::copy(x.begin(), x.end(), begin()));
         destroy_a(i, end(), this->get_allocator());
@@ -203,7 +204,7 @@ public:
                              this->get_allocator());
       this->_m_impl._m_finish += n - size();
     } else {
-      erase(fill_n(begin(), n, val), end());
+      erase(std::fill_n(begin(), n, val), end());
     }
   }
 
@@ -272,6 +273,12 @@ public:
     return size_type(const_iterator(this->_m_impl._m_end_of_storage) - begin());
   }
 
+  void shrink_to_fit() {
+    if (capacity() != size()) {
+      _reallocate(size());
+    }
+  }
+
   /* ------------------------------- modifiers ------------------------------ */
   void clear() { erase(begin(), end()); }
 
@@ -286,30 +293,66 @@ protected:
                          iterator(this->_m_impl._m_finish - 1));
       *position = x_copy;
     } else {
-      size_type const old_size = size();
-      size_type len = old_size != 0 ? 2 * old_size : 1;
-      if (len < old_size) {
-        len = this->max_size();
-      }
-      iterator new_start(this->allocate(len));
-      iterator new_finish(new_start);
-      try {
-        new_finish =
-            uninitialized_copy_a(iterator(this->_m_impl._m_start), position,
-                                 new_start, this->get_allocator());
-        this->_m_impl.construct(new_finish.base(), x);
-        ++new_finish;
-        new_finish =
-            uninitialized_copy_a(position, iterator(this->_m_impl._m_finish),
-                                 new_finish, this->get_allocator());
-      } catch (...) {
-        destroy_a(new_start, new_finish, this->get_allocator());
-        this->deallocate(new_start.base(), len);
-        throw;
+      _realloc_emplace(position, emplace_args1<value_type>(x));
+    }
+  }
+
+  /*
+    The new value is built last so that ctor can still refer to an element of
+    the old storage.
+  */
+  template <typename _T_Ctor>
+  void _realloc_emplace(iterator position, _T_Ctor const &ctor) {
+    size_type const old_size = size();
+    size_type len = old_size != 0 ? 2 * old_size : 1;
+    if (len < old_size) {
+      len = this->max_size();
+    }
+    pointer new_start(this->allocate(len));
+    pointer new_finish(new_start);
+    pointer gap(new_start + (position - begin()));
+    pointer after(gap + 1);
+    try {
+      new_finish = uninitialized_copy_a(this->_m_impl._m_start, position.base(),
+                                        new_start, this->get_allocator());
+      after = uninitialized_copy_a(position.base(), this->_m_impl._m_finish,
+                                   gap + 1, this->get_allocator());
+      ctor(gap);
+    } catch (...) {
+      destroy_a(new_start, new_finish, this->get_allocator());
+      destroy_a(gap + 1, after, this->get_allocator());
+      this->deallocate(new_start, len);
+      throw;
+    }
+    _destroy_deallocate_set(new_start, after, new_start + len);
+  }
+
+  template <typename _T_Ctor> void _emplace_back(_T_Ctor const &ctor) {
+    if (this->_m_impl._m_finish != this->_m_impl._m_end_of_storage) {
+      ctor(this->_m_impl._m_finish);
+      ++this->_m_impl._m_finish;
+    } else {
+      _realloc_emplace(end(), ctor);
+    }
+  }
+
+  /*
+    When there is room left, the value is built in place past the end then
+    rotated to its position, the arguments may refer to a shifted element.
+  */
+  template <typename _T_Ctor>
+  iterator _emplace(iterator position, _T_Ctor const &ctor) {
+    size_type const n = position - begin();
+    if (this->_m_impl._m_finish != this->_m_impl._m_end_of_storage) {
+      ctor(this->_m_impl._m_finish);
+      ++this->_m_impl._m_finish;
+      if (position != end() - 1) {
+        std::rotate(position, end() - 1, end());
       }
-      _destroy_deallocate_set(new_start.base(), new_finish.base(),
-                              new_start.base() + len);
+    } else {
+      _realloc_emplace(position, ctor);
     }
+    return begin() + n;
   }
 
   template <typename _T_InputIterator>
@@ -449,20 +492,35 @@ public:
   }
 
   iterator erase(iterator position) {
+    size_type const n = position - begin();
     if (position + 1 != end()) {
       std::copy(position + 1, end(), position);
     }
     --this->_m_impl._m_finish;
     this->_m_impl.destroy(this->_m_impl._m_finish);
-    return position;
+    return begin() + n;
   }
 
   iterator erase(iterator first, iterator last) {
+    size_type const n = first - begin();
     iterator i(std::copy(last, end(), first));
     destroy_a(i, end(), this->get_allocator());
     this->_m_impl._m_finish =
         this->_m_impl._m_finish - std::distance(first, last);
-    return first;
+    return begin() + n;
+  }
+
+  /*
+    Fills the hole with the last element instead of shifting the whole tail,
+    constant time but the order of the elements is not preserved.
+  */
+  iterator erase_unordered(iterator position) {
+    size_type const n = position - begin();
+    if (position + 1 != end()) {
+      *position = back();
+    }
+    pop_back();
+    return begin() + n;
   }
 
   void push_back(value_type const &value) {
@@ -473,14 +531,53 @@ public:
       _insert(end(), value);
   }
 
+  void emplace_back() { _emplace_back(emplace_args0()); }
+
+  template <typename _T_Arg1> void emplace_back(_T_Arg1 const &a1) {
+    _emplace_back(emplace_args1<_T_Arg1>(a1));
+  }
+
+  template <typename _T_Arg1, typename _T_Arg2>
+  void emplace_back(_T_Arg1 const &a1, _T_Arg2 const &a2) {
+    _emplace_back(emplace_args2<_T_Arg1, _T_Arg2>(a1, a2));
+  }
+
+  template <typename _T_Arg1, typename _T_Arg2, typename _T_Arg3>
+  void emplace_back(_T_Arg1 const &a1, _T_Arg2 const &a2, _T_Arg3 const &a3) {
+    _emplace_back(emplace_args3<_T_Arg1, _T_Arg2, _T_Arg3>(a1, a2, a3));
+  }
+
+  iterator emplace(iterator position) {
+    return _emplace(position, emplace_args0());
+  }
+
+  template <typename _T_Arg1>
+  iterator emplace(iterator position, _T_Arg1 const &a1) {
+    return _emplace(position, emplace_args1<_T_Arg1>(a1));
+  }
+
+  template <typename _T_Arg1, typename _T_Arg2>
+  iterator emplace(iterator position, _T_Arg1 const &a1, _T_Arg2 const &a2) {
+    return _emplace(position, emplace_args2<_T_Arg1, _T_Arg2>(a1, a2));
+  }
+
+  template <typename _T_Arg1, typename _T_Arg2, typename _T_Arg3>
+  iterator emplace(iterator position, _T_Arg1 const &a1, _T_Arg2 const &a2,
+                   _T_Arg3 const &a3) {
+    return _emplace(position,
+                    emplace_args3<_T_Arg1, _T_Arg2, _T_Arg3>(a1, a2, a3));
+  }
+
   void pop_back() {
     --this->_m_impl._m_finish;
     this->_m_impl.destroy(this->_m_impl._m_finish);
+    _auto_shrink();
   }
 
   void resize(size_type count, value_type const &value) {
     if (count < size()) {
       erase(begin() + count, end());
+      _auto_shrink();
     } else {
       insert(end(), count - size(), value);
     }
@@ -488,6 +585,33 @@ public:
 
   void resize(size_type count) { resize(count, value_type()); }
 
+protected:
+  void _default_append(size_type n, true_type) {
+    if (size_type(this->_m_impl._m_end_of_storage - this->_m_impl._m_finish) <
+        n) {
+      reserve(size() + std::max(size(), n));
+    }
+    this->_m_impl._m_finish += n;
+  }
+
+  void _default_append(size_type n, false_type) {
+    insert(end(), n, value_type());
+  }
+
+public:
+  /*
+    Same as resize() but the new elements are left uninitialized when
+    value_type is a scalar, they are meant to be overwritten right after (e.g.
+    by read(2)). Other types are default constructed.
+  */
+  void resize_uninitialized(size_type count) {
+    if (count < size()) {
+      erase(begin() + count, end());
+    } else {
+      _default_append(count - size(), typename is_scalar<value_type>::type());
+    }
+  }
+
   void swap(_t_self &other) {
     std::swap(this->_m_impl._m_start, other._m_impl._m_start);
     std::swap(this->_m_impl._m_finish, other._m_impl._m_finish);
@@ -536,8 +660,35 @@ private:
     }
   }
 
+  void _reallocate(size_type n) {
+    size_type const old_size = size();
+    pointer tmp = NULL;
+    if (n != 0) {
+      tmp = _allocate_and_copy(n, this->_m_impl._m_start,
+                               this->_m_impl._m_finish);
+    }
+    _destroy_deallocate_set(tmp, tmp + old_size, tmp + n);
+  }
+
+  /*
+    Defining FT_VECTOR_AUTO_SHRINK makes the vector give back memory once its
+    size drops below a quarter of its capacity. Shrinking to twice the size
+    keeps push_back and pop_back amortized constant. Only pop_back and a
+    shrinking resize apply it, and they then invalidate every iterator and
+    reference; erase keeps the ones before the erased elements valid.
+  */
+  void _auto_shrink() {
+#ifdef FT_VECTOR_AUTO_SHRINK
+    if (size() < capacity() / 4) {
+      _reallocate(2 * size());
+    }
+#endif
+  }
+
   void _destroy_deallocate_set(pointer new_start, pointer new_finish,
                                pointer end_of_storage) {
+    trace_policy::record(TRACE_VECTOR_REALLOCATE,
+                         (end_of_storage - new_start) * sizeof(value_type));
     destroy_a(begin(), end(), this->get_allocator());
     this->deallocate(this->_m_impl._m_start,
                      this->_m_impl._m_end_of_storage - this->_m_impl._m_start);
@@ -554,18 +705,32 @@ inline void swap(vector<_T_Value, _T_Allocator> &lhs,
   lhs.swap(rhs);
 }
 
+/*
+  Removes every element matching pred in a single pass, each kept element is
+  moved at most once instead of shifting the tail on every erase.
+*/
+template <typename _T_Value, typename _T_Allocator, typename _T_Predicate>
+typename vector<_T_Value, _T_Allocator>::size_type
+erase_if(vector<_T_Value, _T_Allocator> &v, _T_Predicate pred) {
+  typename vector<_T_Value, _T_Allocator>::iterator it =
+      std::remove_if(v.begin(), v.end(), pred);
+  typename vector<_T_Value, _T_Allocator>::size_type const n = v.end() - it;
+  v.erase(it, v.end());
+  return n;
+}
+
 template <typename _T_Value, typename _T_Allocator>
 inline bool operator==(vector<_T_Value, _T_Allocator> const &lhs,
                        vector<_T_Value, _T_Allocator> const &rhs) {
   return (lhs.size() == rhs.size() &&
-          equal(lhs.begin(), lhs.end(), rhs.begin()));
+          ft::equal(lhs.begin(), lhs.end(), rhs.begin()));
 }
 
 template <typename _T_Value, typename _T_Allocator>
 inline bool operator<(vector<_T_Value, _T_Allocator> const &lhs,
                       vector<_T_Value, _T_Allocator> const &rhs) {
-  return lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(),
-                                 rhs.end());
+  return ft::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(),
+                                     rhs.end());
 }
 
 template <typename _T_Value, typename _T_Allocator>
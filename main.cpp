@@ -1,7 +1,10 @@
+#include "ft/trace.hpp"
 #include "tests/tests.hpp"
+#include "tests/utils/bench.hpp"
 #include "tests/utils/logger.hpp"
 
 #include <algorithm>
+#include <iostream>
 #include <map>
 #include <set>
 
@@ -10,19 +13,59 @@ int main(int argc, char **argv) {
 
   std::map<std::string, tests_fn> containers;
   NEW_TEST(containers, "vector", &tests_vector_impl, &tests_vector_perf);
-  NEW_TEST(containers, "stack", &tests_stack_impl, nullptr);
+  NEW_TEST(containers, "stack", &tests_stack_impl, &tests_stack_perf);
+  NEW_TEST(containers, "concurrent_stack", &tests_concurrent_stack_impl,
+           &tests_concurrent_stack_perf);
+  NEW_TEST(containers, "deque", &tests_deque_impl, &tests_deque_perf);
+  NEW_TEST(containers, "ring", &tests_ring_impl, &tests_ring_perf);
+  NEW_TEST(containers, "priority_queue", &tests_priority_queue_impl,
+           &tests_priority_queue_perf);
   NEW_TEST(containers, "set", &tests_set_impl, &tests_set_perf);
   NEW_TEST(containers, "map", &tests_map_impl, &tests_map_perf);
+  NEW_TEST(containers, "intrusive_tree", &tests_intrusive_tree_impl,
+           &tests_intrusive_tree_perf);
+  NEW_TEST(containers, "interval_map", &tests_interval_map_impl,
+           &tests_interval_map_perf);
+  NEW_TEST(containers, "trace", &tests_trace_impl, &tests_trace_perf);
 
   std::set<std::string> targets;
   bool do_impl_test = true;
   bool do_perf_test = true;
+  char const *trace_path = NULL;
 
   for (int i = 1; i < argc; ++i) {
     if (argv[i] == std::string("-P")) {
       do_perf_test = false;
     } else if (argv[i] == std::string("-I")) {
       do_impl_test = false;
+    } else if (argv[i] == std::string("--counters")) {
+      if (!Bench::enable_counters()) {
+        std::cerr << "hardware counters unavailable, timings only"
+                  << std::endl;
+      }
+    } else if (argv[i] == std::string("--sweep") && i + 1 < argc) {
+      if (!Bench::sweep(argv[++i])) {
+        std::cerr << "--sweep takes a range of powers of two, e.g. 6:26"
+                  << std::endl;
+        return 1;
+      }
+    } else if (argv[i] == std::string("--csv") && i + 1 < argc) {
+      if (!Bench::open_csv(argv[++i])) {
+        std::cerr << "cannot open " << argv[i] << std::endl;
+        return 1;
+      }
+    } else if (argv[i] == std::string("--json") && i + 1 < argc) {
+      if (!Bench::open_json(argv[++i])) {
+        std::cerr << "cannot open " << argv[i] << std::endl;
+        return 1;
+      }
+    } else if (argv[i] == std::string("--trace") && i + 1 < argc) {
+      trace_path = argv[++i];
+      if (!ft::trace_policy::enabled) {
+        std::cerr << "tracing is compiled out, build with TRACE=1"
+                  << std::endl;
+        return 1;
+      }
     } else if (containers.find(argv[i]) != containers.end()) {
       targets.insert(argv[i]);
     }
@@ -39,4 +82,9 @@ int main(int argc, char **argv) {
       }
     }
   }
+
+  if (trace_path != NULL && !ft::trace_policy::dump(trace_path)) {
+    std::cerr << "cannot write " << trace_path << std::endl;
+    return 1;
+  }
 }
\ No newline at end of file
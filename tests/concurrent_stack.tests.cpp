@@ -0,0 +1,250 @@
+#include <cstddef>
+#include <iostream>
+#include <pthread.h>
+#include <sstream>
+#include <stack>
+#include <vector>
+
+#include "../ft/concurrent_stack.hpp"
+#include "../ft/stack.hpp"
+
+#include "utils/chrono.hpp"
+#include "utils/logger.hpp"
+#include "utils/testing_struct.hpp"
+
+// the baseline follows the build, ft::concurrent_stack has no std counterpart
+#ifdef STD
+#define STK std::stack
+#else
+#define STK ft::stack
+#endif
+
+#define CONCURRENT_STACK_PERF_BASE_SIZE 1000000 // 1 000 000
+#define CONCURRENT_STACK_MAX_THREADS 8
+
+/*
+  What the threads were sharing a stack for until now: every operation goes
+  through one mutex.
+*/
+template <typename T> class locked_stack {
+  pthread_mutex_t m_mutex;
+  STK<T> m_stack;
+
+  locked_stack(locked_stack const &);
+  locked_stack &operator=(locked_stack const &);
+
+public:
+  locked_stack() { pthread_mutex_init(&m_mutex, NULL); }
+
+  ~locked_stack() { pthread_mutex_destroy(&m_mutex); }
+
+  void push(T const &x) {
+    pthread_mutex_lock(&m_mutex);
+    m_stack.push(x);
+    pthread_mutex_unlock(&m_mutex);
+  }
+
+  bool try_pop(T &out) {
+    pthread_mutex_lock(&m_mutex);
+    bool const found = !m_stack.empty();
+    if (found) {
+      out = m_stack.top();
+      m_stack.pop();
+    }
+    pthread_mutex_unlock(&m_mutex);
+    return found;
+  }
+};
+
+template <typename S> struct concurrent_stack_worker {
+  S *stack;
+  int id;
+  int ops;
+  int const *start;
+  long popped;
+  long sum;
+
+  static void *push_then_pop(void *arg) {
+    concurrent_stack_worker *w = static_cast<concurrent_stack_worker *>(arg);
+    while (!__atomic_load_n(w->start, __ATOMIC_ACQUIRE)) {
+    }
+    int value;
+    for (int i = 0; i < w->ops; ++i) {
+      w->stack->push(w->id * w->ops + i);
+    }
+    while (w->stack->try_pop(value)) {
+      ++w->popped;
+      w->sum += value;
+    }
+    return NULL;
+  }
+
+  // a work list: every thread takes its share out right after putting it in
+  static void *interleaved(void *arg) {
+    concurrent_stack_worker *w = static_cast<concurrent_stack_worker *>(arg);
+    while (!__atomic_load_n(w->start, __ATOMIC_ACQUIRE)) {
+    }
+    int value;
+    for (int i = 0; i < w->ops; ++i) {
+      w->stack->push(w->id * w->ops + i);
+      if (w->stack->try_pop(value)) {
+        ++w->popped;
+        w->sum += value;
+      }
+    }
+    return NULL;
+  }
+};
+
+// totals over all threads, the stack is drained by the caller afterwards
+template <typename S>
+void concurrent_stack_run(S &stack, int threads, int ops,
+                          void *(*routine)(void *), long &popped, long &sum) {
+  std::vector<pthread_t> ids(threads);
+  std::vector<concurrent_stack_worker<S> > workers(threads);
+  int start = 0;
+  for (int t = 0; t < threads; ++t) {
+    concurrent_stack_worker<S> w = {&stack, t, ops, &start, 0, 0};
+    workers[t] = w;
+    if (pthread_create(&ids[t], NULL, routine, &workers[t]) != 0) {
+      std::cerr << "could not start thread " << t << ", running with " << t
+                << std::endl;
+      threads = t;
+      break;
+    }
+  }
+  __atomic_store_n(&start, 1, __ATOMIC_RELEASE);
+  for (int t = 0; t < threads; ++t) {
+    pthread_join(ids[t], NULL);
+    popped += workers[t].popped;
+    sum += workers[t].sum;
+  }
+}
+
+template <typename T>
+void concurrent_stack_impl_test(std::string const &type_name) {
+  print_data(type_name);
+
+  ft::concurrent_stack<T> s;
+  T value;
+
+  print_data(s.empty());
+  print_data(s.try_pop(value));
+
+  for (int i = 0; i < 10; ++i) {
+    s.push(T(i));
+  }
+  print_data(s.empty());
+
+  while (s.try_pop(value)) {
+    print_data(value);
+  }
+  print_data(s.empty());
+
+  // popped nodes are reused
+  std::size_t const capacity = s.capacity();
+  for (int i = 0; i < 10; ++i) {
+    s.push(T(i));
+  }
+  print_data(s.capacity() == capacity);
+
+  s.reserve(1000);
+  print_data(s.capacity() >= 1000);
+  while (s.try_pop(value)) {
+    print_data(value);
+  }
+
+  // destroyed with elements left
+  for (int i = 0; i < 500; ++i) {
+    s.push(T(i));
+  }
+}
+
+void concurrent_stack_threads_impl_test(int threads) {
+  int const ops = 100000;
+  long const n = long(threads) * ops;
+  std::ostringstream name;
+  name << threads << " threads";
+  print_data(name.str());
+
+  ft::concurrent_stack<int> s;
+  long popped = 0;
+  long sum = 0;
+  concurrent_stack_run(s, threads, ops,
+                       &concurrent_stack_worker<ft::concurrent_stack<int> >::
+                           push_then_pop,
+                       popped, sum);
+  print_data(popped == n && sum == n * (n - 1) / 2);
+
+  popped = 0;
+  sum = 0;
+  concurrent_stack_run(s, threads, ops,
+                       &concurrent_stack_worker<ft::concurrent_stack<int> >::
+                           interleaved,
+                       popped, sum);
+  int value;
+  while (s.try_pop(value)) {
+    ++popped;
+    sum += value;
+  }
+  print_data(popped == n && sum == n * (n - 1) / 2);
+  // an element in flight per thread at most
+  print_data(s.capacity() <= std::size_t(threads) * ops);
+}
+
+void tests_concurrent_stack_impl() {
+  print_header("concurrent_stack impl");
+
+  Chrono chrono("concurrent_stack impl");
+  chrono.begin();
+
+  concurrent_stack_impl_test<int>("int");
+  concurrent_stack_impl_test<testing_struct>("testing_struct");
+
+  for (int t = 1; t <= CONCURRENT_STACK_MAX_THREADS; t *= 2) {
+    concurrent_stack_threads_impl_test(t);
+  }
+
+  chrono.stop("total impl");
+  chrono.print();
+}
+
+/*
+  Contention benchmark: the same total amount of work is split over more and
+  more threads all hammering one stack, once lock-free and once behind a mutex.
+*/
+template <typename S>
+void concurrent_stack_contention_test(Chrono &chrono, std::string const &name,
+                                      int threads) {
+  S s;
+  long popped = 0;
+  long sum = 0;
+  int const ops = CONCURRENT_STACK_PERF_BASE_SIZE / threads;
+  std::ostringstream label;
+  label << name << " " << threads << " threads";
+
+  chrono.stop("setup " + label.str());
+  concurrent_stack_run(s, threads, ops,
+                       &concurrent_stack_worker<S>::push_then_pop, popped,
+                       sum);
+  chrono.stop("push then pop " + label.str());
+  concurrent_stack_run(s, threads, ops,
+                       &concurrent_stack_worker<S>::interleaved, popped, sum);
+  chrono.stop("interleaved " + label.str());
+}
+
+void tests_concurrent_stack_perf() {
+  print_header("concurrent_stack perf");
+
+  Chrono chrono("concurrent_stack perf");
+  chrono.begin();
+
+  for (int t = 1; t <= CONCURRENT_STACK_MAX_THREADS; t *= 2) {
+    concurrent_stack_contention_test<ft::concurrent_stack<int> >(
+        chrono, "lock-free", t);
+    concurrent_stack_contention_test<locked_stack<int> >(chrono, "mutex", t);
+  }
+
+  chrono.stop("total perf");
+  chrono.print();
+}
@@ -0,0 +1,322 @@
+#include <cassert>
+#include <cstddef>
+#include <deque>
+#include <stdexcept>
+#include <vector>
+
+#include "utils/chrono.hpp"
+#include "utils/latency.hpp"
+#include "utils/logger.hpp"
+#include "utils/testing_struct.hpp"
+
+#ifdef STD
+#define DEQ std::deque
+#define SWAP std::swap
+#else
+#include "../ft/deque.hpp"
+#define DEQ ft::deque
+#define SWAP ft::swap
+#endif
+
+#define DEQUE_PERF_BASE_SIZE 1000000 // 1 000 000
+
+#define DEQUE_PRINT_STATE(deq) deque_print_state(deq, #deq)
+template <typename T>
+void deque_print_state(DEQ<T> const &d, std::string const &name) {
+  print_data(name);
+  print_data(d.size());
+  for (typename DEQ<T>::const_iterator it = d.begin(); it != d.end(); ++it) {
+    print_data(*it);
+  }
+}
+
+template <typename T> void deque_impl_test(std::string const &type_name) {
+  print_data(type_name);
+
+  std::vector<int> data;
+  for (int i = 0; i < 10; ++i) {
+    data.push_back(i);
+  }
+
+  DEQ<T> default_constructor;
+  DEQUE_PRINT_STATE(default_constructor);
+
+  DEQ<T> fill_constructor(2, 2);
+  DEQUE_PRINT_STATE(fill_constructor);
+
+  DEQ<T> range_constructor(data.begin(), data.end());
+  DEQUE_PRINT_STATE(range_constructor);
+
+  DEQ<T> copy_constructor(range_constructor);
+  DEQUE_PRINT_STATE(copy_constructor);
+
+  DEQ<T> const const_fill_constructor(10);
+  DEQUE_PRINT_STATE(const_fill_constructor);
+
+  DEQ<T> const const_range_constructor(data.begin(), data.end());
+  DEQUE_PRINT_STATE(const_range_constructor);
+
+  fill_constructor = copy_constructor;
+  deque_print_state(fill_constructor, "assign operator");
+
+  print_data(*range_constructor.begin());
+  print_data(*const_range_constructor.begin());
+
+  print_data(*(--range_constructor.end()));
+  print_data(*(--const_range_constructor.end()));
+
+  print_data(*range_constructor.rbegin());
+  print_data(*const_range_constructor.rbegin());
+
+  print_data(*(--range_constructor.rend()));
+  print_data(*(--const_range_constructor.rend()));
+
+  print_data(range_constructor.size());
+  print_data(range_constructor.empty());
+  print_data(default_constructor.empty());
+
+  print_data(range_constructor[range_constructor.size() / 2]);
+  print_data(const_range_constructor[const_range_constructor.size() / 2]);
+
+  try {
+    print_data(range_constructor.at(range_constructor.size()));
+  } catch (std::out_of_range &e) {
+    print_data("deque::at");
+  }
+
+  print_data(range_constructor.front());
+  print_data(const_range_constructor.back());
+
+  // several blocks on both sides of the initial one
+  for (int i = 0; i < 3000; ++i) {
+    default_constructor.push_back(T(i));
+    default_constructor.push_front(T(-i));
+  }
+  print_data(default_constructor.size());
+  print_data(default_constructor.front());
+  print_data(default_constructor.back());
+  print_data(default_constructor[1500]);
+  print_data(default_constructor.end() - default_constructor.begin());
+  print_data(*(default_constructor.begin() + 4500));
+  print_data(*(default_constructor.end() - 4500));
+
+  // references stay valid when growing at either end
+  T &first = default_constructor.front();
+  T &last = default_constructor.back();
+  for (int i = 0; i < 10000; ++i) {
+    default_constructor.push_back(T(i));
+    default_constructor.push_front(T(i));
+  }
+  assert(&first == &default_constructor[10000]);
+  assert(&last == &default_constructor[default_constructor.size() - 10001]);
+
+  for (int i = 0; i < 12500; ++i) {
+    default_constructor.pop_back();
+    default_constructor.pop_front();
+  }
+  deque_print_state(default_constructor, "pop back and front");
+
+  default_constructor.resize(20);
+  deque_print_state(default_constructor, "resize");
+
+  default_constructor.resize(1000, T(7));
+  print_data(default_constructor.size());
+  print_data(default_constructor.back());
+
+  fill_constructor.assign(5, T(0));
+  deque_print_state(fill_constructor, "assign fill");
+
+  fill_constructor.assign(data.begin(), data.end());
+  deque_print_state(fill_constructor, "assign range");
+
+  print_data(*range_constructor.insert(range_constructor.begin() + 3, T(42)));
+  deque_print_state(range_constructor, "insert position front half");
+
+  print_data(*range_constructor.insert(range_constructor.end() - 2, T(43)));
+  deque_print_state(range_constructor, "insert position back half");
+
+  range_constructor.insert(range_constructor.begin() + 2, 5, T(44));
+  deque_print_state(range_constructor, "insert fill front half");
+
+  range_constructor.insert(range_constructor.end() - 1, 600, T(45));
+  print_data(range_constructor.size());
+  print_data(range_constructor.back());
+  print_data(range_constructor[range_constructor.size() - 2]);
+
+  range_constructor.insert(range_constructor.begin() + 1, data.begin(),
+                           data.end());
+  print_data(range_constructor.size());
+  print_data(range_constructor[5]);
+
+  range_constructor.insert(range_constructor.end(), data.rbegin(),
+                           data.rend());
+  print_data(range_constructor.back());
+
+  print_data(*range_constructor.erase(range_constructor.begin() + 2));
+  print_data(*range_constructor.erase(range_constructor.end() - 3));
+  print_data(range_constructor.size());
+
+  print_data(*range_constructor.erase(range_constructor.begin() + 1,
+                                      range_constructor.begin() + 10));
+  print_data(*range_constructor.erase(range_constructor.begin() + 20,
+                                      range_constructor.end() - 5));
+  deque_print_state(range_constructor, "erase range");
+
+  range_constructor.clear();
+  deque_print_state(range_constructor, "clear");
+  range_constructor.push_front(T(1));
+  deque_print_state(range_constructor, "push front after clear");
+
+  range_constructor = copy_constructor;
+  print_data(range_constructor == copy_constructor);
+  print_data(range_constructor != default_constructor);
+  print_data(range_constructor < default_constructor);
+  print_data(range_constructor <= copy_constructor);
+  print_data(range_constructor > fill_constructor);
+  print_data(range_constructor >= copy_constructor);
+
+  typename DEQ<T>::iterator it = default_constructor.begin();
+  typename DEQ<T>::const_iterator cit = default_constructor.begin();
+  print_data(it == cit);
+  print_data(it != ++cit);
+  print_data(cit - it);
+  print_data(it < cit);
+
+  DEQ<T> one(data.begin(), data.end());
+  DEQ<T> two(data.rbegin(), data.rend());
+  typename DEQ<T>::iterator one_begin = one.begin();
+  typename DEQ<T>::iterator two_begin = two.begin();
+
+  one.swap(two);
+  assert(one_begin == two.begin());
+  assert(two_begin == one.begin());
+  print_data(*(one_begin + 1));
+  print_data(*(two_begin + 1));
+
+  SWAP(one, two);
+  assert(one_begin == one.begin());
+  assert(two_begin == two.begin());
+  print_data(one.back());
+  print_data(two.back());
+}
+
+void tests_deque_impl() {
+  print_header("deque impl");
+
+  Chrono chrono("deque impl");
+  chrono.begin();
+
+  deque_impl_test<int>("int");
+  deque_impl_test<float>("float");
+  deque_impl_test<testing_struct>("testing_struct");
+
+  chrono.stop("total impl");
+  chrono.print();
+}
+
+/*
+  Per operation latency of the end operations, the interesting part is the
+  tail: a deque pays for a new block every few hundred pushes and for a map
+  reallocation once in a while, but never moves its elements.
+*/
+template <typename T> void deque_latency_test(std::string const &type_name) {
+  DEQ<T> d;
+
+  Latency push_back(type_name + " push back", DEQUE_PERF_BASE_SIZE);
+  for (int i = 0; i < DEQUE_PERF_BASE_SIZE; ++i) {
+    push_back.begin();
+    d.push_back(T(i));
+    push_back.stop();
+  }
+  push_back.print();
+
+  Latency pop_back(type_name + " pop back", DEQUE_PERF_BASE_SIZE);
+  for (int i = 0; i < DEQUE_PERF_BASE_SIZE; ++i) {
+    pop_back.begin();
+    d.pop_back();
+    pop_back.stop();
+  }
+  pop_back.print();
+
+  Latency push_front(type_name + " push front", DEQUE_PERF_BASE_SIZE);
+  for (int i = 0; i < DEQUE_PERF_BASE_SIZE; ++i) {
+    push_front.begin();
+    d.push_front(T(i));
+    push_front.stop();
+  }
+  push_front.print();
+
+  Latency pop_front(type_name + " pop front", DEQUE_PERF_BASE_SIZE);
+  for (int i = 0; i < DEQUE_PERF_BASE_SIZE; ++i) {
+    pop_front.begin();
+    d.pop_front();
+    pop_front.stop();
+  }
+  pop_front.print();
+}
+
+template <typename T> void deque_perf_test(std::string const &type_name) {
+  Chrono chrono(type_name);
+  chrono.begin();
+
+  DEQ<T> d;
+  for (int i = 0; i < DEQUE_PERF_BASE_SIZE; ++i) {
+    d.push_back(T(i));
+  }
+  chrono.stop("push back");
+
+  for (int i = 0; i < DEQUE_PERF_BASE_SIZE; ++i) {
+    d.push_front(T(i));
+  }
+  chrono.stop("push front");
+
+  for (std::size_t i = 0; i < d.size(); ++i) {
+    d[i] = d[d.size() - i - 1];
+  }
+  chrono.stop("random access");
+
+  for (typename DEQ<T>::iterator it = d.begin(); it != d.end(); ++it) {
+    *it = T(0);
+  }
+  chrono.stop("iterate");
+
+  // queue usage: the deque slides through memory at a constant size
+  for (int i = 0; i < DEQUE_PERF_BASE_SIZE * 2; ++i) {
+    d.push_back(T(i));
+    d.pop_front();
+  }
+  chrono.stop("fifo");
+
+  for (int i = 0; i < DEQUE_PERF_BASE_SIZE; ++i) {
+    d.pop_back();
+  }
+  chrono.stop("pop back");
+
+  for (int i = 0; i < 100; ++i) {
+    d.insert(d.begin() + d.size() / 2, T(i));
+  }
+  chrono.stop("insert middle");
+
+  d.erase(d.begin() + d.size() / 4, d.end() - d.size() / 4);
+  chrono.stop("erase range");
+
+  d.clear();
+  chrono.stop("clear");
+
+  chrono.print();
+
+  deque_latency_test<T>(type_name);
+}
+
+void tests_deque_perf() {
+  print_header("deque perf");
+
+  Chrono chrono("deque perf");
+  chrono.begin();
+
+  deque_perf_test<int>("int");
+  deque_perf_test<testing_struct>("testing_struct");
+
+  chrono.stop("total perf");
+  chrono.print();
+}
@@ -0,0 +1,402 @@
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "utils/bench.hpp"
+#include "utils/chrono.hpp"
+#include "utils/logger.hpp"
+
+#ifdef STD
+#include <map>
+#define MAP std::map
+#else
+#include "../ft/interval_map.hpp"
+#include "../ft/map.hpp"
+#define MAP ft::map
+#endif
+
+#define INTERVAL_PERF_SIZE 200000       // 200 000
+#define INTERVAL_PERF_SPAN 1000000000   // bounds in [0, 10^9)
+#define INTERVAL_PERF_LENGTH 100000     // lengths in [0, 10^5)
+#define INTERVAL_PERF_WINDOW 1000000    // overlap queries of 10^6
+#define INTERVAL_PERF_QUERIES 1024
+
+struct interval_entry {
+  int low;
+  int high;
+  int value;
+};
+
+// same sequence in both builds
+static unsigned interval_random(unsigned &state) {
+  state = state * 1103515245u + 12345u;
+  return state >> 1;
+}
+
+/*
+  What an ordered map of intervals offers: a scan from the first key, which
+  can stop at the first interval starting after the query.
+*/
+class interval_scan_index {
+  typedef MAP<std::pair<int, int>, int> map;
+
+  map m_map;
+
+public:
+  bool insert(int low, int high, int value) {
+    return m_map.insert(map::value_type(std::make_pair(low, high), value))
+        .second;
+  }
+
+  std::size_t erase(int low, int high) {
+    return m_map.erase(std::make_pair(low, high));
+  }
+
+  void overlapping(int low, int high, std::vector<interval_entry> &out) const {
+    out.clear();
+    for (map::const_iterator it = m_map.begin();
+         it != m_map.end() && it->first.first <= high; ++it) {
+      if (it->first.second >= low) {
+        interval_entry const e = {it->first.first, it->first.second,
+                                  it->second};
+        out.push_back(e);
+      }
+    }
+  }
+
+  void stabbing(int p, std::vector<interval_entry> &out) const {
+    overlapping(p, p, out);
+  }
+
+  bool find_overlap(int low, int high, interval_entry &e) const {
+    for (map::const_iterator it = m_map.begin();
+         it != m_map.end() && it->first.first <= high; ++it) {
+      if (it->first.second >= low) {
+        e.low = it->first.first;
+        e.high = it->first.second;
+        e.value = it->second;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  std::size_t size() const { return m_map.size(); }
+
+  void clear() { m_map.clear(); }
+};
+
+#ifdef STD
+typedef interval_scan_index interval_index;
+#else
+// appends the entries the iterators written to it point to
+template <typename Iterator> struct interval_entry_inserter {
+  std::vector<interval_entry> *out;
+
+  interval_entry_inserter(std::vector<interval_entry> &out) : out(&out) {}
+
+  interval_entry_inserter &operator*() { return *this; }
+
+  interval_entry_inserter &operator++() { return *this; }
+
+  interval_entry_inserter &operator=(Iterator const &it) {
+    interval_entry const e = {it->first.low, it->first.high, it->second};
+    out->push_back(e);
+    return *this;
+  }
+};
+
+class interval_index {
+  typedef ft::interval_map<int, int> map;
+  typedef interval_entry_inserter<map::const_iterator> inserter;
+
+  map m_map;
+
+public:
+  bool insert(int low, int high, int value) {
+    return m_map.insert(map::value_type(map::key_type(low, high), value))
+        .second;
+  }
+
+  std::size_t erase(int low, int high) {
+    return m_map.erase(map::key_type(low, high));
+  }
+
+  void overlapping(int low, int high, std::vector<interval_entry> &out) const {
+    out.clear();
+    m_map.overlapping(map::key_type(low, high), inserter(out));
+  }
+
+  void stabbing(int p, std::vector<interval_entry> &out) const {
+    out.clear();
+    m_map.stabbing(p, inserter(out));
+  }
+
+  bool find_overlap(int low, int high, interval_entry &e) const {
+    map::const_iterator const it = m_map.find_overlap(map::key_type(low, high));
+    if (it == m_map.end()) {
+      return false;
+    }
+    e.low = it->first.low;
+    e.high = it->first.high;
+    e.value = it->second;
+    return true;
+  }
+
+  std::size_t size() const { return m_map.size(); }
+
+  void clear() { m_map.clear(); }
+};
+#endif
+
+static void interval_print(std::vector<interval_entry> const &entries) {
+  print_data(entries.size());
+  for (std::size_t i = 0; i < entries.size(); ++i) {
+    print_data(entries[i].low);
+    print_data(entries[i].high);
+    print_data(entries[i].value);
+  }
+}
+
+// count and checksum of the answer, for the larger tests
+static void interval_summary(std::vector<interval_entry> const &entries) {
+  long sum = 0;
+  for (std::size_t i = 0; i < entries.size(); ++i) {
+    sum += entries[i].value * long(i + 1);
+  }
+  print_data(entries.size());
+  print_data(sum);
+}
+
+void interval_small_impl_test() {
+  print_data("small");
+
+  int const bounds[][2] = {{1, 5},  {2, 3},  {4, 9},   {6, 7},
+                           {8, 12}, {10, 10}, {15, 20}, {1, 2}};
+  interval_index index;
+  for (int i = 0; i < 8; ++i) {
+    print_data(index.insert(bounds[i][0], bounds[i][1], i));
+  }
+  print_data(index.insert(4, 9, 100));
+  print_data(index.size());
+
+  std::vector<interval_entry> out;
+  for (int p = 0; p <= 21; ++p) {
+    index.stabbing(p, out);
+    interval_print(out);
+  }
+  index.overlapping(3, 6, out);
+  interval_print(out);
+  index.overlapping(13, 14, out);
+  interval_print(out);
+  index.overlapping(-5, 100, out);
+  interval_print(out);
+
+  interval_entry e = {0, 0, 0};
+  print_data(index.find_overlap(7, 8, e));
+  print_data(e.low);
+  print_data(e.value);
+  print_data(index.find_overlap(13, 14, e));
+  print_data(index.find_overlap(20, 30, e));
+  print_data(e.low);
+
+  // the copy keeps answering once the original changes
+  interval_index copy(index);
+  print_data(index.erase(4, 9));
+  print_data(index.erase(4, 9));
+  print_data(index.erase(15, 20));
+  index.stabbing(6, out);
+  interval_print(out);
+  index.overlapping(11, 30, out);
+  interval_print(out);
+  copy.stabbing(6, out);
+  interval_print(out);
+  copy.overlapping(11, 30, out);
+  interval_print(out);
+
+  copy = index;
+  copy.overlapping(-5, 100, out);
+  interval_print(out);
+  index.clear();
+  print_data(index.size());
+  index.stabbing(6, out);
+  interval_print(out);
+}
+
+// enough inserts and erases that every rotation case keeps the maxima right
+void interval_random_impl_test() {
+  print_data("random");
+
+  unsigned state = 42;
+  std::vector<std::pair<int, int> > inserted;
+  interval_index index;
+  for (int i = 0; i < 2000; ++i) {
+    int const low = interval_random(state) % 100000;
+    int const high = low + interval_random(state) % 2000;
+    if (index.insert(low, high, i)) {
+      inserted.push_back(std::make_pair(low, high));
+    }
+  }
+  print_data(index.size());
+
+  std::vector<interval_entry> out;
+  for (int round = 0; round < 2; ++round) {
+    for (int q = 0; q < 100; ++q) {
+      int const p = interval_random(state) % 102000;
+      index.stabbing(p, out);
+      interval_summary(out);
+      int const low = interval_random(state) % 102000;
+      index.overlapping(low, low + interval_random(state) % 5000, out);
+      interval_summary(out);
+      interval_entry e = {0, 0, 0};
+      print_data(index.find_overlap(low, low + 10, e) ? e.value : -1);
+    }
+    for (std::size_t i = round; i < inserted.size(); i += 2) {
+      index.erase(inserted[i].first, inserted[i].second);
+    }
+    print_data(index.size());
+  }
+}
+
+void tests_interval_map_impl() {
+  print_header("interval_map impl");
+
+  Chrono chrono("interval_map impl");
+  chrono.begin();
+
+  interval_small_impl_test();
+  interval_random_impl_test();
+
+  chrono.stop("total impl");
+  chrono.print();
+}
+
+// inserts every interval, from an empty index
+template <typename Index> struct interval_insert_case : bench_case {
+  Index &index;
+  std::vector<std::pair<int, int> > const &intervals;
+
+  interval_insert_case(Index &index,
+                       std::vector<std::pair<int, int> > const &intervals)
+      : index(index), intervals(intervals) {}
+
+  void setup(std::size_t) { index.clear(); }
+
+  void operator()(std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      index.insert(intervals[i].first, intervals[i].second, i);
+    }
+    clobber_memory();
+  }
+};
+
+// erases an interval and inserts it back, the size stays the same
+template <typename Index> struct interval_erase_insert_case : bench_case {
+  Index &index;
+  std::vector<std::pair<int, int> > const &intervals;
+  std::size_t next;
+
+  interval_erase_insert_case(Index &index,
+                             std::vector<std::pair<int, int> > const &intervals)
+      : index(index), intervals(intervals), next(0) {}
+
+  void operator()(std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      std::pair<int, int> const &k =
+          intervals[(next * 7919) % intervals.size()];
+      index.erase(k.first, k.second);
+      index.insert(k.first, k.second, next);
+      next = next + 1 == intervals.size() ? 0 : next + 1;
+    }
+    clobber_memory();
+  }
+};
+
+// cycles through the query points, a window of width from each
+template <typename Index> struct interval_query_case : bench_case {
+  Index const &index;
+  std::vector<int> const &points;
+  int width;
+  std::size_t next;
+  std::vector<interval_entry> out;
+
+  interval_query_case(Index const &index, std::vector<int> const &points,
+                      int width)
+      : index(index), points(points), width(width), next(0) {}
+
+  void operator()(std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      index.overlapping(points[next], points[next] + width, out);
+      do_not_optimize(out.size());
+      next = next + 1 == points.size() ? 0 : next + 1;
+    }
+  }
+};
+
+void interval_perf_test() {
+  std::size_t const n = INTERVAL_PERF_SIZE;
+
+  unsigned state = 42;
+  std::vector<std::pair<int, int> > intervals;
+  intervals.reserve(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    int const low = interval_random(state) % INTERVAL_PERF_SPAN;
+    int const length = interval_random(state) % INTERVAL_PERF_LENGTH;
+    intervals.push_back(std::make_pair(low, low + length));
+  }
+  std::vector<int> points;
+  for (int i = 0; i < INTERVAL_PERF_QUERIES; ++i) {
+    points.push_back(interval_random(state) % INTERVAL_PERF_SPAN);
+  }
+
+  interval_scan_index scan;
+  Bench bench("interval_map", "int:int");
+  bench.size(n);
+
+  // std has no interval tree, only the scans are run in both builds
+#ifndef STD
+  interval_index index;
+  interval_insert_case<interval_index> insert(index, intervals);
+  bench.run("insert", insert, n);
+  interval_erase_insert_case<interval_index> erase_insert(index, intervals);
+  bench.run("erase insert", erase_insert);
+  interval_query_case<interval_index> stabbing(index, points, 0);
+  bench.run("stabbing", stabbing);
+  interval_query_case<interval_index> overlap(index, points,
+                                              INTERVAL_PERF_WINDOW);
+  bench.run("overlap", overlap);
+#endif
+
+  interval_insert_case<interval_scan_index> insert_scan(scan, intervals);
+  bench.run("insert scan", insert_scan, n);
+  interval_query_case<interval_scan_index> stabbing_scan(scan, points, 0);
+  bench.run("stabbing scan", stabbing_scan);
+  interval_query_case<interval_scan_index> overlap_scan(scan, points,
+                                                        INTERVAL_PERF_WINDOW);
+  bench.run("overlap scan", overlap_scan);
+  bench.print();
+
+  std::vector<interval_entry> out;
+  std::size_t stabbed = 0;
+  std::size_t overlapped = 0;
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    scan.stabbing(points[i], out);
+    stabbed += out.size();
+    scan.overlapping(points[i], points[i] + INTERVAL_PERF_WINDOW, out);
+    overlapped += out.size();
+  }
+  print_data(double(stabbed) / points.size());
+  print_data(double(overlapped) / points.size());
+}
+
+void tests_interval_map_perf() {
+  print_header("interval_map perf");
+
+  Chrono chrono("interval_map perf");
+  chrono.begin();
+
+  interval_perf_test();
+
+  chrono.stop("total perf");
+  chrono.print();
+}
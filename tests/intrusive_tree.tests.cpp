@@ -0,0 +1,357 @@
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "utils/bench.hpp"
+#include "utils/chrono.hpp"
+#include "utils/logger.hpp"
+
+#ifdef STD
+#include <map>
+#else
+#include "../ft/intrusive_tree.hpp"
+#endif
+
+#define INTRUSIVE_PERF_SIZE 100000 // 100 000
+
+// objects indexed by id (unique) and by priority (repeated)
+struct by_id {};
+struct by_priority {};
+
+struct record
+#ifndef STD
+    : ft::intrusive_hook<by_id>,
+      ft::intrusive_hook<by_priority>
+#endif
+{
+  int id;
+  int priority;
+
+  record(int id = 0, int priority = 0) : id(id), priority(priority) {}
+};
+
+struct record_id {
+  int const &operator()(record const &r) const { return r.id; }
+};
+
+struct record_priority {
+  int const &operator()(record const &r) const { return r.priority; }
+};
+
+/*
+  An index over records the caller owns. std has no intrusive container, the
+  usual replacement is a multimap of pointers: every insert allocates a node
+  and erasing a given record looks for it among the equivalent keys. Same
+  interface as the ft version over ft::intrusive_tree.
+*/
+#ifdef STD
+template <typename KeyOfValue, typename Tag> class record_index {
+  typedef std::multimap<int, record *> map;
+
+  map m_map;
+
+  typename map::iterator locate(record &r) {
+    std::pair<typename map::iterator, typename map::iterator> range =
+        m_map.equal_range(KeyOfValue()(r));
+    for (; range.first != range.second; ++range.first) {
+      if (range.first->second == &r) {
+        return range.first;
+      }
+    }
+    return m_map.end();
+  }
+
+public:
+  bool insert(record &r) {
+    int const k = KeyOfValue()(r);
+    typename map::iterator it = m_map.lower_bound(k);
+    if (it != m_map.end() && it->first == k) {
+      return false;
+    }
+    m_map.insert(it, std::make_pair(k, &r));
+    return true;
+  }
+
+  void insert_equal(record &r) {
+    m_map.insert(std::make_pair(KeyOfValue()(r), &r));
+  }
+
+  void erase(record &r) { m_map.erase(locate(r)); }
+
+  std::size_t erase(int k) { return m_map.erase(k); }
+
+  record *find(int k) {
+    typename map::iterator it = m_map.lower_bound(k);
+    return it == m_map.end() || it->first != k ? NULL : it->second;
+  }
+
+  bool linked(record &r) { return locate(r) != m_map.end(); }
+
+  std::size_t count(int k) const { return m_map.count(k); }
+
+  // records with a key in [low, high], in order
+  std::vector<record *> range(int low, int high) {
+    std::vector<record *> out;
+    typename map::iterator const last = m_map.upper_bound(high);
+    for (typename map::iterator it = m_map.lower_bound(low); it != last;
+         ++it) {
+      out.push_back(it->second);
+    }
+    return out;
+  }
+
+  std::vector<record *> reversed() {
+    std::vector<record *> out;
+    for (typename map::reverse_iterator it = m_map.rbegin();
+         it != m_map.rend(); ++it) {
+      out.push_back(it->second);
+    }
+    return out;
+  }
+
+  std::size_t size() const { return m_map.size(); }
+
+  void clear() { m_map.clear(); }
+};
+#else
+template <typename KeyOfValue, typename Tag> class record_index {
+  typedef ft::intrusive_tree<int, record, KeyOfValue, std::less<int>, Tag>
+      tree;
+
+  tree m_tree;
+
+public:
+  bool insert(record &r) { return m_tree.insert(r).second; }
+
+  void insert_equal(record &r) { m_tree.insert_equal(r); }
+
+  void erase(record &r) { m_tree.unlink(r); }
+
+  std::size_t erase(int k) { return m_tree.erase(k); }
+
+  record *find(int k) {
+    typename tree::iterator it = m_tree.find(k);
+    return it == m_tree.end() ? NULL : &*it;
+  }
+
+  bool linked(record &r) {
+    return static_cast<ft::intrusive_hook<Tag> &>(r).is_linked();
+  }
+
+  std::size_t count(int k) const { return m_tree.count(k); }
+
+  std::vector<record *> range(int low, int high) {
+    std::vector<record *> out;
+    typename tree::iterator const last = m_tree.upper_bound(high);
+    for (typename tree::iterator it = m_tree.lower_bound(low); it != last;
+         ++it) {
+      out.push_back(&*it);
+    }
+    return out;
+  }
+
+  std::vector<record *> reversed() {
+    std::vector<record *> out;
+    for (typename tree::reverse_iterator it = m_tree.rbegin();
+         it != m_tree.rend(); ++it) {
+      out.push_back(&*it);
+    }
+    return out;
+  }
+
+  std::size_t size() const { return m_tree.size(); }
+
+  void clear() { m_tree.clear(); }
+};
+#endif
+
+typedef record_index<record_id, by_id> id_index;
+typedef record_index<record_priority, by_priority> priority_index;
+
+static void intrusive_print(std::vector<record *> const &records) {
+  print_data(records.size());
+  for (std::size_t i = 0; i < records.size(); ++i) {
+    print_data(records[i]->id);
+    print_data(records[i]->priority);
+  }
+}
+
+void intrusive_tree_impl_test() {
+  print_data("two indexes");
+
+  // distinct ids in scattered order, seven priorities
+  std::vector<record> records;
+  for (int i = 0; i < 100; ++i) {
+    records.push_back(record((i * 37) % 101, i % 7));
+  }
+
+  id_index ids;
+  priority_index priorities;
+  for (std::size_t i = 0; i < records.size(); ++i) {
+    print_data(ids.insert(records[i]));
+    priorities.insert_equal(records[i]);
+  }
+  print_data(ids.size());
+  print_data(priorities.size());
+
+  record duplicate(records[5].id, 3);
+  print_data(ids.insert(duplicate));
+  print_data(ids.linked(duplicate));
+  print_data(ids.linked(records[5]));
+
+  intrusive_print(ids.range(10, 30));
+  // equivalent keys stay in insertion order
+  intrusive_print(priorities.range(3, 3));
+  print_data(priorities.count(3));
+  print_data(ids.find(42) ? ids.find(42)->priority : -1);
+  print_data(ids.find(1000) == NULL);
+
+  // unlinked from one index, still in the other
+  for (std::size_t i = 0; i < records.size(); i += 3) {
+    ids.erase(records[i]);
+  }
+  print_data(ids.size());
+  print_data(ids.linked(records[3]));
+  print_data(priorities.linked(records[3]));
+  intrusive_print(ids.range(0, 20));
+
+  print_data(priorities.erase(2));
+  print_data(priorities.erase(2));
+  print_data(priorities.size());
+  print_data(priorities.linked(records[2]));
+  intrusive_print(priorities.reversed());
+
+  // erased records can be linked again
+  for (std::size_t i = 0; i < records.size(); i += 3) {
+    print_data(ids.insert(records[i]));
+  }
+  print_data(ids.size());
+  intrusive_print(ids.reversed());
+
+  ids.clear();
+  priorities.clear();
+  print_data(ids.size());
+  print_data(ids.linked(records[0]));
+  print_data(priorities.linked(records[1]));
+  print_data(ids.insert(records[0]));
+  print_data(ids.size());
+  ids.clear();
+}
+
+void tests_intrusive_tree_impl() {
+  print_header("intrusive_tree impl");
+
+  Chrono chrono("intrusive_tree impl");
+  chrono.begin();
+
+  intrusive_tree_impl_test();
+
+  chrono.stop("total impl");
+  chrono.print();
+}
+
+// links every record in both indexes, in scattered order, from empty ones
+struct intrusive_insert_case : bench_case {
+  std::vector<record> &records;
+  id_index &ids;
+  priority_index &priorities;
+
+  intrusive_insert_case(std::vector<record> &records, id_index &ids,
+                        priority_index &priorities)
+      : records(records), ids(ids), priorities(priorities) {}
+
+  void setup(std::size_t) {
+    ids.clear();
+    priorities.clear();
+  }
+
+  void operator()(std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      record &r = records[(i * 7919) % records.size()];
+      ids.insert(r);
+      priorities.insert_equal(r);
+    }
+    clobber_memory();
+  }
+};
+
+struct intrusive_find_case : bench_case {
+  id_index &ids;
+  std::size_t size;
+  std::size_t next;
+
+  intrusive_find_case(id_index &ids, std::size_t size)
+      : ids(ids), size(size), next(0) {}
+
+  void operator()(std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      do_not_optimize(ids.find((next * 104729) % size));
+      next = next + 1 == size ? 0 : next + 1;
+    }
+  }
+};
+
+// a record changes priority: out of both indexes and back in
+struct intrusive_update_case : bench_case {
+  std::vector<record> &records;
+  id_index &ids;
+  priority_index &priorities;
+  std::size_t next;
+
+  intrusive_update_case(std::vector<record> &records, id_index &ids,
+                        priority_index &priorities)
+      : records(records), ids(ids), priorities(priorities), next(0) {}
+
+  void operator()(std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      record &r = records[(next * 7919) % records.size()];
+      ids.erase(r);
+      priorities.erase(r);
+      r.priority = (r.priority + 1) % (records.size() / 4);
+      ids.insert(r);
+      priorities.insert_equal(r);
+      next = next + 1 == records.size() ? 0 : next + 1;
+    }
+    clobber_memory();
+  }
+};
+
+void intrusive_tree_perf_test() {
+  std::size_t const n = INTRUSIVE_PERF_SIZE;
+
+  // about four records per priority
+  std::vector<record> records;
+  records.reserve(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    records.push_back(record(i, (i * 31) % (n / 4)));
+  }
+
+  id_index ids;
+  priority_index priorities;
+  Bench bench("intrusive_tree", "record");
+  bench.size(n);
+
+  intrusive_insert_case insert(records, ids, priorities);
+  bench.run("insert two indexes", insert, n);
+  intrusive_find_case find(ids, n);
+  bench.run("find", find);
+  intrusive_update_case update(records, ids, priorities);
+  bench.run("update", update);
+  bench.print();
+
+  ids.clear();
+  priorities.clear();
+}
+
+void tests_intrusive_tree_perf() {
+  print_header("intrusive_tree perf");
+
+  Chrono chrono("intrusive_tree perf");
+  chrono.begin();
+
+  intrusive_tree_perf_test();
+
+  chrono.stop("total perf");
+  chrono.print();
+}
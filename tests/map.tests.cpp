@@ -1,10 +1,17 @@
+#include <algorithm>
 #include <cassert>
+#include <sstream>
 #include <string>
 #include <vector>
 
+#include "utils/bench.hpp"
 #include "utils/chrono.hpp"
+#include "utils/counting_compare.hpp"
 #include "utils/logger.hpp"
 #include "utils/testing_struct.hpp"
+#include "utils/threads.hpp"
+#include "utils/tracking_allocator.hpp"
+#include "utils/workload.hpp"
 
 #ifdef STD
 #include <map>
@@ -13,10 +20,44 @@
 #else
 #include "../ft/map.hpp"
 #include "../ft/utility.hpp"
+#include "utils/tree_stats.hpp"
 #define LIB ft
 #endif
 
+#ifdef STD
+template <typename M, typename A1, typename A2>
+LIB::pair<typename M::iterator, bool> map_emplace(M &m, A1 const &a1,
+                                                  A2 const &a2) {
+  return m.insert(typename M::value_type(a1, a2));
+}
+
+template <typename M, typename A1, typename A2>
+typename M::iterator map_emplace_hint(M &m, typename M::iterator pos,
+                                      A1 const &a1, A2 const &a2) {
+  return m.insert(pos, typename M::value_type(a1, a2));
+}
+#else
+template <typename M, typename A1, typename A2>
+LIB::pair<typename M::iterator, bool> map_emplace(M &m, A1 const &a1,
+                                                  A2 const &a2) {
+  return m.emplace(a1, a2);
+}
+
+template <typename M, typename A1, typename A2>
+typename M::iterator map_emplace_hint(M &m, typename M::iterator pos,
+                                      A1 const &a1, A2 const &a2) {
+  return m.emplace_hint(pos, a1, a2);
+}
+#endif
+
 #define MAP_PERF_BASE_SIZE 1000000 // 1 000 000
+#define MAP_WORKLOAD_SIZE 65536
+#define MAP_THREADS_SIZE 100000 // 100 000
+#define MAP_THREADS_OPS 200000  // 200 000 per thread
+#define MAP_THREADS_MAX 8
+#define MAP_TREE_STATS_SIZE 100000 // 100 000
+#define MAP_COMPARISONS_SIZE 100000 // 100 000
+#define MAP_TRAVERSAL_WIDTH 64
 
 #define MAP_PRINT_STATE(map) map_print_state(map, #map)
 template <typename K, typename V>
@@ -173,6 +214,18 @@ void map_impl_test(std::string const &key_type, std::string const &val_type) {
   range_constructor.insert(data2.begin(), data2.end());
   map_print_state(range_constructor, "insert range");
 
+  print_data(map_emplace(range_constructor, 60, 60).first->second);
+  print_data(map_emplace(range_constructor, 60, 61).second);
+  map_print_state(range_constructor, "emplace");
+
+  print_data(
+      map_emplace_hint(range_constructor, range_constructor.end(), 61, 61)
+          ->second);
+  print_data(
+      map_emplace_hint(range_constructor, range_constructor.begin(), 61, 62)
+          ->second);
+  map_print_state(range_constructor, "emplace hint");
+
   range_constructor.erase(range_constructor.begin());
   map_print_state(range_constructor, "erase position");
 
@@ -214,9 +267,52 @@ void map_impl_test(std::string const &key_type, std::string const &val_type) {
   map_print_state(two, "swap 2 two");
 }
 
+template <typename M> struct map_find_case : bench_case {
+  M const &m;
+  typename M::key_type key;
+
+  map_find_case(M const &m, typename M::key_type const &key)
+      : m(m), key(key) {}
+
+  void operator()(std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      do_not_optimize(m.find(key));
+    }
+  }
+};
+
+enum map_hint { MAP_NO_HINT, MAP_WRONG_HINT, MAP_CORRECT_HINT };
+
+// one insert and the erase undoing it per operation, the size stays constant
+template <typename M> struct map_insert_erase_case : bench_case {
+  M &m;
+  typename M::value_type value;
+  map_hint hint;
+
+  map_insert_erase_case(M &m, typename M::value_type const &value,
+                        map_hint hint)
+      : m(m), value(value), hint(hint) {}
+
+  void operator()(std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      if (hint == MAP_NO_HINT) {
+        m.insert(value);
+      } else if (hint == MAP_WRONG_HINT) {
+        m.insert(m.begin(), value);
+      } else {
+        m.insert(--m.end(), value);
+      }
+      m.erase(value.first);
+    }
+  }
+};
+
 template <typename K, typename V>
 void map_perf_test(std::string const &key_type, std::string const &val_type) {
+  typedef LIB::map<K, V> map;
+
   Chrono chrono(key_type + ":" + val_type);
+  Bench bench("map", key_type + ":" + val_type);
   chrono.begin();
 
   std::vector<LIB::pair<K, V> > v1;
@@ -229,51 +325,608 @@ void map_perf_test(std::string const &key_type, std::string const &val_type) {
     v2.push_back(LIB::make_pair(i, i));
   }
 
-  LIB::map<K, V> m(v1.rbegin(), v1.rend());
+  map m(v1.rbegin(), v1.rend());
   chrono.stop("fill constructor");
 
-  m.insert(LIB::make_pair(MAP_PERF_BASE_SIZE + 1, MAP_PERF_BASE_SIZE + 1));
-  chrono.stop("insert value");
+  m.insert(v2.rbegin(), v2.rend());
+  chrono.stop("insert range");
+  bench.size(m.size());
+
+  typename map::value_type const value(K(MAP_PERF_BASE_SIZE * 2 + 1), V(1));
+  map_insert_erase_case<map> insert_value(m, value, MAP_NO_HINT);
+  bench.run("insert erase value", insert_value);
+  map_insert_erase_case<map> wrong_hint(m, value, MAP_WRONG_HINT);
+  bench.run("insert erase value wrong hint", wrong_hint);
+  map_insert_erase_case<map> correct_hint(m, value, MAP_CORRECT_HINT);
+  bench.run("insert erase value correct hint", correct_hint);
+
+  map_find_case<map> find_begin(m, m.begin()->first);
+  bench.run("find begin", find_begin);
+  map_find_case<map> find_middle(m, MAP_PERF_BASE_SIZE);
+  bench.run("find middle", find_middle);
+  map_find_case<map> find_end(m, (--m.end())->first);
+  bench.run("find end", find_end);
+  chrono.stop("single operations");
+
+  typename map::iterator end = m.begin();
+  for (int i = 0; i < MAP_PERF_BASE_SIZE; ++i) {
+    ++end;
+  }
+  m.erase(m.begin(), end);
+  chrono.stop("erase range");
 
-  m.insert(m.begin(),
-           LIB::make_pair(MAP_PERF_BASE_SIZE + 2, MAP_PERF_BASE_SIZE + 2));
-  chrono.stop("insert value wrong hint");
+  m.clear();
+  chrono.stop("clear");
 
-  m.insert(--m.end(),
-           LIB::make_pair(MAP_PERF_BASE_SIZE + 3, MAP_PERF_BASE_SIZE + 3));
-  chrono.stop("insert value correct hint");
+  chrono.print();
+  bench.print();
+}
 
-  m.insert(v2.rbegin(), v2.rend());
-  chrono.stop("insert range");
+// finds cycling through keys, every one in the map
+template <typename M> struct map_find_random_case : bench_case {
+  M const &m;
+  std::vector<typename M::key_type> const &keys;
+  std::size_t next;
+
+  map_find_random_case(M const &m,
+                       std::vector<typename M::key_type> const &keys)
+      : m(m), keys(keys), next(0) {}
+
+  void operator()(std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      do_not_optimize(m.find(keys[next]));
+      if (++next == keys.size()) {
+        next = 0;
+      }
+    }
+  }
+};
+
+// erases a key and inserts it back, the size stays constant
+template <typename M> struct map_erase_insert_random_case : bench_case {
+  M &m;
+  std::vector<typename M::key_type> const &keys;
+  std::size_t next;
+
+  map_erase_insert_random_case(M &m,
+                               std::vector<typename M::key_type> const &keys)
+      : m(m), keys(keys), next(0) {}
+
+  void operator()(std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      m.erase(keys[next]);
+      m.insert(typename M::value_type(keys[next], typename M::mapped_type()));
+      if (++next == keys.size()) {
+        next = 0;
+      }
+    }
+  }
+};
+
+// one increment per operation, wrapping around at the end
+template <typename M> struct map_iterate_case : bench_case {
+  M const &m;
+  typename M::const_iterator it;
+
+  map_iterate_case(M const &m) : m(m), it(m.begin()) {}
+
+  void operator()(std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      do_not_optimize(it->second);
+      if (++it == m.end()) {
+        it = m.begin();
+      }
+    }
+  }
+};
+
+// one decrement per operation, wrapping around at the beginning
+template <typename M> struct map_reverse_iterate_case : bench_case {
+  M const &m;
+  typename M::const_iterator it;
+
+  map_reverse_iterate_case(M const &m) : m(m), it(m.end()) {}
+
+  void operator()(std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      if (it == m.begin()) {
+        it = m.end();
+      }
+      --it;
+      do_not_optimize(it->second);
+    }
+  }
+};
+
+// one lower_bound..upper_bound scan per operation, over [lows[i], highs[i]]
+template <typename M> struct map_range_scan_case : bench_case {
+  M const &m;
+  std::vector<typename M::key_type> const &lows;
+  std::vector<typename M::key_type> const &highs;
+  std::size_t next;
+
+  map_range_scan_case(M const &m,
+                      std::vector<typename M::key_type> const &lows,
+                      std::vector<typename M::key_type> const &highs)
+      : m(m), lows(lows), highs(highs), next(0) {}
+
+  void operator()(std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      typename M::const_iterator it = m.lower_bound(lows[next]);
+      typename M::const_iterator const last = m.upper_bound(highs[next]);
+      for (; it != last; ++it) {
+        do_not_optimize(it->second);
+      }
+      if (++next == lows.size()) {
+        next = 0;
+      }
+    }
+  }
+};
+
+// inserts the stream into the emptied map, one key per operation
+template <typename M> struct map_insert_stream_case : bench_case {
+  M &m;
+  std::vector<typename M::key_type> const &keys;
+
+  map_insert_stream_case(M &m, std::vector<typename M::key_type> const &keys)
+      : m(m), keys(keys) {}
+
+  void setup(std::size_t) { m.clear(); }
+
+  void operator()(std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      m.insert(typename M::value_type(keys[i], typename M::mapped_type()));
+    }
+  }
+};
+
+/*
+  Reads are finds, writes erase the key when it is there and insert it
+  otherwise, so the size stays around where it started.
+*/
+template <typename M> struct map_mix_case : bench_case {
+  M &m;
+  std::vector<Workload::operation> const &operations;
+  std::vector<typename M::key_type> const &keys;
+  std::size_t next;
+
+  map_mix_case(M &m, std::vector<Workload::operation> const &operations,
+               std::vector<typename M::key_type> const &keys)
+      : m(m), operations(operations), keys(keys), next(0) {}
+
+  void operator()(std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      if (operations[next].read) {
+        do_not_optimize(m.find(keys[next]));
+      } else if (m.erase(keys[next]) == 0) {
+        m.insert(
+            typename M::value_type(keys[next], typename M::mapped_type()));
+      }
+      if (++next == operations.size()) {
+        next = 0;
+      }
+    }
+  }
+};
+
+// converted once, out of the timed loops
+template <typename K>
+std::vector<K> map_workload_keys(std::vector<Workload::operation> const &ops) {
+  std::vector<K> keys;
+  keys.reserve(ops.size());
+  for (std::size_t i = 0; i < ops.size(); ++i) {
+    keys.push_back(K(ops[i].key));
+  }
+  return keys;
+}
 
-  m.find(m.begin()->first);
-  chrono.stop("find begin");
+// every distribution: filling an empty map, finds, then mixed traffic
+template <typename K, typename V>
+void map_workload_perf_test(std::string const &key_type,
+                            std::string const &val_type) {
+  typedef LIB::map<K, V> map;
+
+  Bench bench("map", key_type + ":" + val_type);
+  bench.size(MAP_WORKLOAD_SIZE);
+  unsigned const mixes[] = {95, 50};
+
+  for (int d = 0; d < Workload::distribution_count; ++d) {
+    Workload::distribution const dist = Workload::distribution(d);
+    std::string const name = Workload::name(dist);
+    std::vector<Workload::operation> const stream =
+        Workload(dist, MAP_WORKLOAD_SIZE).operations(MAP_WORKLOAD_SIZE, 0);
+    std::vector<K> const keys = map_workload_keys<K>(stream);
+
+    map m;
+    map_insert_stream_case<map> insert(m, keys);
+    bench.run(name + " insert", insert, keys.size());
+    map_find_random_case<map> find(m, keys);
+    bench.run(name + " find", find);
+
+    for (std::size_t i = 0; i < sizeof(mixes) / sizeof(*mixes); ++i) {
+      std::vector<Workload::operation> const ops =
+          Workload(dist, MAP_WORKLOAD_SIZE, 43)
+              .operations(MAP_WORKLOAD_SIZE, mixes[i]);
+      std::vector<K> const mix_keys = map_workload_keys<K>(ops);
+      map_mix_case<map> mix(m, ops, mix_keys);
+      std::ostringstream label;
+      label << name << " " << mixes[i] << "/" << 100 - mixes[i];
+      bench.run(label.str(), mix);
+    }
+  }
+  bench.print();
+}
+
+/*
+  One case per thread, over the map of its index, or over the first one
+  when shared. Every thread has its own key order.
+*/
+template <typename F, typename M, typename K>
+void map_threads_run(Threads &threads, std::string const &name,
+                     std::vector<M> &maps, bool shared,
+                     std::vector<std::vector<K> > const &orders) {
+  std::vector<F *> cases;
+  for (std::size_t t = 0; t < orders.size(); ++t) {
+    cases.push_back(new F(maps[shared ? 0 : t], orders[t]));
+  }
+  std::ostringstream label;
+  label << name << (shared ? " shared" : " per thread");
+  threads.run(label.str(), cases, MAP_THREADS_OPS);
+  for (std::size_t t = 0; t < cases.size(); ++t) {
+    delete cases[t];
+  }
+}
+
+// const lookups on one map against a map per thread, and per thread writes
+template <typename K, typename V>
+void map_threads_perf_test(std::string const &key_type,
+                           std::string const &val_type) {
+  typedef LIB::map<K, V> map;
+
+  std::vector<K> keys;
+  for (int i = 0; i < MAP_THREADS_SIZE; ++i) {
+    keys.push_back(K(i));
+  }
+  std::random_shuffle(keys.begin(), keys.end());
+  std::vector<map> maps(1);
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    maps[0].insert(typename map::value_type(keys[i], V()));
+  }
+
+  Threads threads("map", key_type + ":" + val_type);
+  for (std::size_t n = 1; n <= MAP_THREADS_MAX; n *= 2) {
+    std::vector<std::vector<K> > orders(n, keys);
+    for (std::size_t t = 0; t < n; ++t) {
+      std::random_shuffle(orders[t].begin(), orders[t].end());
+    }
+    maps.resize(n, maps[0]);
+
+    map_threads_run<map_find_random_case<map> >(threads, "find", maps, true,
+                                                 orders);
+    map_threads_run<map_find_random_case<map> >(threads, "find", maps,
+                                                 false, orders);
+    map_threads_run<map_erase_insert_random_case<map> >(
+        threads, "erase insert", maps, false, orders);
+  }
+  threads.print();
+}
 
-  m.find(MAP_PERF_BASE_SIZE);
-  chrono.stop("find middle");
+/*
+  Same operations at every size of the sweep, the keys are inserted and
+  looked up in random order so the nodes are spread over the heap as they
+  are after a real workload.
+*/
+template <typename K, typename V>
+void map_sweep_perf_test(std::string const &key_type,
+                         std::string const &val_type) {
+  typedef LIB::map<K, V> map;
+
+  Bench bench("map", key_type + ":" + val_type);
+  std::vector<std::size_t> const &sizes = Bench::sweep_sizes();
+
+  for (std::size_t i = 0; i < sizes.size(); ++i) {
+    std::vector<K> keys;
+    keys.reserve(sizes[i]);
+    for (std::size_t k = 0; k < sizes[i]; ++k) {
+      keys.push_back(K(int(k)));
+    }
+    std::random_shuffle(keys.begin(), keys.end());
+    map m;
+    for (std::size_t k = 0; k < keys.size(); ++k) {
+      m.insert(typename map::value_type(keys[k], V(int(k))));
+    }
+    bench.size(m.size());
+
+    map_find_random_case<map> find(m, keys);
+    bench.run("find random", find);
+    map_erase_insert_random_case<map> erase_insert(m, keys);
+    bench.run("erase insert random", erase_insert);
+    map_iterate_case<map> iterate(m);
+    bench.run("iterate", iterate);
+  }
+  bench.print_curves();
+}
 
-  m.find((--m.end())->first);
-  chrono.stop("find end");
+/*
+  In-order traversal where the memory order of the nodes matches the key
+  order (sorted inserts), does not (scattered inserts), or used to before
+  half of the keys were erased and inserted back (churned). Run with
+  --counters to see the cache misses of the iterator increments.
+*/
+template <typename K, typename V>
+void map_traversal_perf_test(std::string const &key_type,
+                             std::string const &val_type) {
+  typedef LIB::map<K, V> map;
+  char const *const layouts[] = {"sorted", "scattered", "churned"};
+  // from cache resident to far out, unless a sweep was asked for
+  std::vector<std::size_t> const sizes = Bench::sweep_sizes_or(10, 20, 5);
+
+  for (std::size_t l = 0; l < sizeof(layouts) / sizeof(*layouts); ++l) {
+    Bench bench("map", key_type + ":" + val_type + " " + layouts[l]);
+    for (std::size_t i = 0; i < sizes.size(); ++i) {
+      std::vector<int> order;
+      for (std::size_t k = 0; k < sizes[i]; ++k) {
+        order.push_back(int(k));
+      }
+      std::random_shuffle(order.begin(), order.end());
+      std::vector<K> lows;
+      std::vector<K> highs;
+      for (std::size_t k = 0; k < order.size(); ++k) {
+        lows.push_back(K(order[k]));
+        highs.push_back(K(order[k] + MAP_TRAVERSAL_WIDTH - 1));
+      }
+
+      map m;
+      for (std::size_t k = 0; k < sizes[i]; ++k) {
+        int const key = l == 1 ? order[k] : int(k);
+        m.insert(typename map::value_type(K(key), V(key)));
+      }
+      if (l == 2) {
+        for (std::size_t k = 0; k < order.size() / 2; ++k) {
+          m.erase(lows[k]);
+        }
+        for (std::size_t k = 0; k < order.size() / 2; ++k) {
+          m.insert(typename map::value_type(lows[k], V(order[k])));
+        }
+      }
+      bench.size(m.size());
+
+      map_iterate_case<map> forward(m);
+      bench.run("forward", forward);
+      map_reverse_iterate_case<map> reverse(m);
+      bench.run("reverse", reverse);
+      map_range_scan_case<map> range(m, lows, highs);
+      std::ostringstream label;
+      label << "range " << MAP_TRAVERSAL_WIDTH;
+      bench.run(label.str(), range);
+    }
+    bench.print_curves();
+  }
+}
 
-  m.erase(++m.begin());
-  chrono.stop("erase position");
+void map_emplace_perf_test() {
+  Chrono chrono("int:testing_struct emplace");
+  testing_struct const value(0, 'c', std::string(64, 'x'));
+  chrono.begin();
 
-  m.erase(MAP_PERF_BASE_SIZE);
-  chrono.stop("erase value");
+  LIB::map<int, testing_struct> m1;
+  for (int i = 0; i < MAP_PERF_BASE_SIZE; ++i) {
+    m1.insert(m1.end(), LIB::make_pair(i, value));
+  }
+  chrono.stop("insert temporary");
 
-  typename LIB::map<K, V>::iterator end = m.begin();
+  LIB::map<int, testing_struct> m2;
   for (int i = 0; i < MAP_PERF_BASE_SIZE; ++i) {
-    ++end;
+    map_emplace_hint(m2, m2.end(), i, value);
   }
-  m.erase(m.begin(), end);
-  chrono.stop("erase range");
+  chrono.stop("emplace hint");
 
-  m.clear();
-  chrono.stop("clear");
+  for (int i = 0; i < MAP_PERF_BASE_SIZE; ++i) {
+    map_emplace(m2, i, value);
+  }
+  chrono.stop("emplace existing");
 
   chrono.print();
 }
 
+// the nodes come from the rebound allocator, sharing the same stats
+void map_allocator_impl_test() {
+  typedef LIB::pair<int const, testing_struct> value_type;
+  typedef LIB::map<int, testing_struct, std::less<int>,
+                   tracking_allocator<value_type> >
+      map;
+
+  print_data("tracking allocator");
+  allocation_stats stats;
+  {
+    tracking_allocator<value_type> const alloc(&stats);
+    map m(std::less<int>(), alloc);
+    for (int i = 0; i < 100; ++i) {
+      m.insert(value_type(i, testing_struct(i)));
+      m[i] = testing_struct(-i);
+    }
+    print_data(stats.allocations());
+    map copy(m);
+    copy.erase(copy.begin(), copy.find(50));
+    print_data(copy.get_allocator().stats() == &stats);
+    print_data(stats.allocations());
+    print_data(stats.deallocations());
+  }
+  print_data(stats.allocations() == stats.deallocations());
+  print_data(stats.live());
+}
+
+void map_compare_impl_test() {
+  typedef LIB::map<int, int, counting_compare<int> > map;
+
+  print_data("counting compare");
+  std::size_t count = 0;
+  map m((counting_compare<int>(&count)));
+  for (int i = 0; i < 100; ++i) {
+    m[(i * 37) % 100] = i;
+  }
+  print_data(count > 0);
+  print_data(m.key_comp().count() == &count);
+  map copy(m);
+  print_data(copy.key_comp().count() == &count);
+  std::size_t const before = count;
+  print_data(copy.find(42)->second);
+  print_data(count > before);
+  print_data(copy.size());
+  for (map::const_iterator it = copy.begin(); it != copy.end(); ++it) {
+    print_data(it->first);
+    print_data(it->second);
+  }
+}
+
+// keys of the comparison tests, the strings share a prefix as paths do
+template <typename K> K map_comparison_key(std::size_t i) { return K(i); }
+
+template <> std::string map_comparison_key<std::string>(std::size_t i) {
+  std::ostringstream key;
+  key << "/var/lib/records/" << i;
+  return key.str();
+}
+
+/*
+  Comparator calls per operation, where a comparator heavy key spends its
+  time: sorted input with and without an end() hint and built from a range
+  should cost far less than scattered inserts.
+*/
+template <typename K, typename V>
+void map_comparisons_perf_test(std::string const &key_type,
+                               std::string const &val_type) {
+  typedef counting_compare<K> compare;
+  typedef LIB::map<K, V, compare> map;
+  typedef typename map::value_type value_type;
+  std::size_t const n = MAP_COMPARISONS_SIZE;
+
+  std::vector<value_type> sorted;
+  std::vector<K> keys;
+  for (std::size_t i = 0; i < n; ++i) {
+    keys.push_back(map_comparison_key<K>(i));
+  }
+  // the strings do not sort like the numbers they hold
+  std::sort(keys.begin(), keys.end());
+  for (std::size_t i = 0; i < n; ++i) {
+    sorted.push_back(value_type(keys[i], V(i)));
+  }
+  std::vector<value_type> scattered;
+  for (std::size_t i = 0; i < n; ++i) {
+    scattered.push_back(sorted[(i * 7919) % n]);
+  }
+
+  std::size_t count = 0;
+  compare const comp(&count);
+  Comparisons comparisons("map " + key_type + ":" + val_type, &count);
+  comparisons.begin();
+
+  map m(comp);
+  for (std::size_t i = 0; i < n; ++i) {
+    m.insert(scattered[i]);
+  }
+  comparisons.stop("scattered insert", n);
+  for (std::size_t i = 0; i < n; ++i) {
+    do_not_optimize(m.find(scattered[i].first));
+  }
+  comparisons.stop("find", n);
+  for (std::size_t i = 0; i < n; ++i) {
+    m[scattered[i].first] = V(i);
+  }
+  comparisons.stop("operator[] existing", n);
+  for (std::size_t i = 0; i < n; i += 2) {
+    m.erase(scattered[i].first);
+  }
+  comparisons.stop("erase", n / 2);
+
+  map in_order(comp);
+  for (std::size_t i = 0; i < n; ++i) {
+    in_order.insert(sorted[i]);
+  }
+  comparisons.stop("sorted insert", n);
+
+  map hinted(comp);
+  for (std::size_t i = 0; i < n; ++i) {
+    hinted.insert(hinted.end(), sorted[i]);
+  }
+  comparisons.stop("sorted insert end hint", n);
+
+  map range(sorted.begin(), sorted.end(), comp);
+  comparisons.stop("sorted range constructor", n);
+  comparisons.print();
+}
+
+template <typename K, typename V>
+void map_allocation_perf_test(std::string const &key_type,
+                              std::string const &val_type) {
+  typedef LIB::pair<K const, V> value_type;
+  typedef LIB::map<K, V, std::less<K>, tracking_allocator<value_type> > map;
+  std::size_t const n = MAP_PERF_BASE_SIZE;
+
+  Allocations allocations("map " + key_type + ":" + val_type);
+  allocations.begin();
+  {
+    map m;
+    for (std::size_t i = 0; i < n; ++i) {
+      m.insert(value_type(K((i * 7919) % n), V(i)));
+    }
+    allocations.stop("insert", n);
+    allocations.footprint("insert", m.size(), sizeof(value_type));
+
+    for (std::size_t i = 0; i < n; ++i) {
+      m[K(i)] = V(i);
+    }
+    allocations.stop("operator[] existing", n);
+
+    map copy(m);
+    allocations.stop("copy constructor", n);
+
+    for (std::size_t i = 0; i < n; i += 2) {
+      m.erase(K(i));
+    }
+    allocations.stop("erase", n / 2);
+
+    copy.clear();
+    allocations.stop("clear", n);
+  }
+  allocations.stop("destruction", n / 2);
+  allocations.print();
+}
+
+#ifndef STD
+/*
+  Shape of the tree and rebalancing work for sorted and scattered insertion
+  orders, then scattered erases. ft only, std has no introspection.
+*/
+template <typename K, typename V>
+void map_tree_stats_perf_test(std::string const &key_type,
+                              std::string const &val_type) {
+  typedef LIB::map<K, V> map;
+  std::size_t const n = MAP_TREE_STATS_SIZE;
+
+  TreeStats stats("map " + key_type + ":" + val_type);
+  map sorted;
+  stats.begin();
+  for (std::size_t i = 0; i < n; ++i) {
+    sorted.insert(LIB::make_pair(K(i), V(i)));
+  }
+  stats.stop("sorted insert", n, sorted.tree_stats());
+
+  map scattered;
+  stats.begin();
+  for (std::size_t i = 0; i < n; ++i) {
+    scattered.insert(LIB::make_pair(K((i * 7919) % n), V(i)));
+  }
+  stats.stop("scattered insert", n, scattered.tree_stats());
+  for (std::size_t i = 0; i < n / 2; ++i) {
+    scattered.erase(K((i * 104729) % n));
+  }
+  stats.stop("scattered erase", n / 2, scattered.tree_stats());
+  stats.print();
+}
+#endif
+
 void tests_map_impl() {
   print_header("map impl");
 
@@ -284,6 +937,8 @@ void tests_map_impl() {
   MAP_CALL_TEST_FN(map_impl_test, char, int);
   MAP_CALL_TEST_FN(map_impl_test, testing_struct, int);
   MAP_CALL_TEST_FN(map_impl_test, float, testing_struct);
+  map_allocator_impl_test();
+  map_compare_impl_test();
 
   chrono.stop("total impl");
   chrono.print();
@@ -295,8 +950,37 @@ void tests_map_perf() {
   Chrono chrono("map perf");
   chrono.begin();
 
+  if (!Bench::sweep_sizes().empty()) {
+    MAP_CALL_TEST_FN(map_sweep_perf_test, int, int);
+    MAP_CALL_TEST_FN(map_sweep_perf_test, testing_struct, int);
+    MAP_CALL_TEST_FN(map_traversal_perf_test, int, int);
+    chrono.stop("total sweep");
+    chrono.print();
+    return;
+  }
+
   MAP_CALL_TEST_FN(map_perf_test, int, char);
   MAP_CALL_TEST_FN(map_perf_test, testing_struct, int);
+  map_emplace_perf_test();
+  chrono.stop("setup workloads");
+  MAP_CALL_TEST_FN(map_workload_perf_test, int, int);
+  MAP_CALL_TEST_FN(map_workload_perf_test, testing_struct, int);
+  chrono.stop("workloads");
+  MAP_CALL_TEST_FN(map_traversal_perf_test, int, int);
+  chrono.stop("traversal");
+  MAP_CALL_TEST_FN(map_threads_perf_test, int, int);
+  chrono.stop("threads");
+#ifndef STD
+  MAP_CALL_TEST_FN(map_tree_stats_perf_test, int, int);
+  MAP_CALL_TEST_FN(map_tree_stats_perf_test, testing_struct, int);
+  chrono.stop("tree stats");
+#endif
+  MAP_CALL_TEST_FN(map_comparisons_perf_test, int, int);
+  MAP_CALL_TEST_FN(map_comparisons_perf_test, testing_struct, int);
+  map_comparisons_perf_test<std::string, int>("string", "int");
+  chrono.stop("comparisons");
+  MAP_CALL_TEST_FN(map_allocation_perf_test, int, char);
+  MAP_CALL_TEST_FN(map_allocation_perf_test, testing_struct, int);
 
   chrono.stop("total perf");
   chrono.print();
@@ -0,0 +1,318 @@
+#include <cstddef>
+#include <cstdlib>
+#include <functional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "../ft/priority_queue.hpp"
+#include "../ft/vector.hpp"
+
+#include "utils/chrono.hpp"
+#include "utils/logger.hpp"
+#include "utils/testing_struct.hpp"
+
+#ifdef STD
+#define PQ std::priority_queue
+#else
+#define PQ ft::priority_queue
+#endif
+
+#define PRIORITY_QUEUE_PERF_BASE_SIZE 1000000 // 1 000 000
+
+// std::priority_queue has no arity, every width is the binary std heap there
+#ifdef STD
+template <typename T, std::size_t Arity> struct priority_queue_arity {
+  typedef std::priority_queue<T> type;
+};
+#else
+template <typename T, std::size_t Arity> struct priority_queue_arity {
+  typedef ft::priority_queue<T, ft::vector<T>, std::less<T>, Arity> type;
+};
+#endif
+
+/*
+  Without decrease-key the usual std workaround is lazy deletion: push the
+  new value again and skip entries that are out of date when they reach the
+  top. Same interface as ft::indexed_priority_queue.
+*/
+#ifdef STD
+template <typename T> class indexed_priority_queue {
+  typedef std::pair<T, std::size_t> entry;
+
+  std::priority_queue<entry> m_queue;
+  std::vector<T> m_values;
+  std::vector<bool> m_queued;
+  std::size_t m_size;
+
+  void skip_stale() {
+    while (!m_queue.empty() && (!m_queued[m_queue.top().second] ||
+                                m_values[m_queue.top().second] <
+                                    m_queue.top().first ||
+                                m_queue.top().first <
+                                    m_values[m_queue.top().second])) {
+      m_queue.pop();
+    }
+  }
+
+public:
+  indexed_priority_queue(std::size_t capacity)
+      : m_values(capacity), m_queued(capacity, false), m_size(0) {}
+
+  std::size_t top_handle() {
+    skip_stale();
+    return m_queue.top().second;
+  }
+
+  T const &top() { return m_values[top_handle()]; }
+
+  bool empty() const { return m_size == 0; }
+
+  std::size_t size() const { return m_size; }
+
+  bool contains(std::size_t h) const {
+    return h < m_queued.size() && m_queued[h];
+  }
+
+  void push(std::size_t h, T const &x) {
+    if (h >= m_queued.size()) {
+      throw std::out_of_range("indexed_priority_queue::push");
+    }
+    if (!m_queued[h]) {
+      m_queued[h] = true;
+      ++m_size;
+    }
+    m_values[h] = x;
+    m_queue.push(entry(x, h));
+  }
+
+  void update(std::size_t h, T const &x) { push(h, x); }
+
+  void erase(std::size_t h) {
+    m_queued[h] = false;
+    --m_size;
+  }
+
+  void pop() { erase(top_handle()); }
+};
+#else
+template <typename T>
+class indexed_priority_queue : public ft::indexed_priority_queue<T> {
+public:
+  indexed_priority_queue(std::size_t capacity)
+      : ft::indexed_priority_queue<T>(capacity) {}
+};
+#endif
+
+// testing_struct only has operator<
+template <typename T> struct priority_queue_greater {
+  bool operator()(T const &lhs, T const &rhs) const { return rhs < lhs; }
+};
+
+template <typename Q> void priority_queue_drain(Q &q) {
+  print_data(q.size());
+  while (!q.empty()) {
+    print_data(q.top());
+    q.pop();
+  }
+  print_data(q.empty());
+}
+
+template <typename T> void priority_queue_impl_test(std::string const &type) {
+  print_data(type);
+
+  std::vector<int> data;
+  for (int i = 0; i < 100; ++i) {
+    data.push_back((i * 37) % 101);
+  }
+
+  PQ<T> default_constructor;
+  print_data(default_constructor.empty());
+  print_data(default_constructor.size());
+  for (std::size_t i = 0; i < data.size(); ++i) {
+    default_constructor.push(T(data[i]));
+    if (i % 10 == 0) {
+      print_data(default_constructor.top());
+    }
+  }
+  priority_queue_drain(default_constructor);
+
+  PQ<T> range_constructor(data.begin(), data.end());
+  priority_queue_drain(range_constructor);
+
+  PQ<T, std::vector<T>, priority_queue_greater<T> > min_queue(data.begin(),
+                                                              data.end());
+  for (int i = 0; i < 10; ++i) {
+    min_queue.pop();
+  }
+  priority_queue_drain(min_queue);
+
+  std::vector<T> container(data.begin(), data.begin() + 20);
+  PQ<T, std::vector<T> > container_constructor(std::less<T>(), container);
+  priority_queue_drain(container_constructor);
+
+  typename priority_queue_arity<T, 4>::type four(data.begin(), data.end());
+  for (int i = 0; i < 50; ++i) {
+    four.pop();
+    four.push(T(data[i] + 1000));
+  }
+  priority_queue_drain(four);
+
+  typename priority_queue_arity<T, 8>::type eight;
+  for (std::size_t i = 0; i < data.size(); ++i) {
+    eight.push(T(data[i]));
+  }
+  for (int i = 0; i < 30; ++i) {
+    eight.pop();
+  }
+  priority_queue_drain(eight);
+}
+
+// values are kept distinct so the top is the same in both builds
+void indexed_priority_queue_impl_test() {
+  print_data("indexed");
+
+  indexed_priority_queue<int> q(100);
+  print_data(q.empty());
+  for (int i = 0; i < 50; ++i) {
+    q.push(i, (i * 37) % 101);
+  }
+  print_data(q.size());
+  print_data(q.top_handle());
+  print_data(q.top());
+
+  // decrease-key on the top, increase-key on the bottom
+  q.update(q.top_handle(), -1);
+  print_data(q.top_handle());
+  q.update(0, 500);
+  print_data(q.top_handle());
+  print_data(q.top());
+
+  q.push(60, 400);
+  print_data(q.contains(60));
+  print_data(q.contains(61));
+  q.erase(0);
+  print_data(q.contains(0));
+  print_data(q.top_handle());
+
+  try {
+    q.push(100, 1);
+  } catch (std::out_of_range &e) {
+    print_data(e.what());
+  }
+
+  print_data(q.size());
+  while (!q.empty()) {
+    print_data(q.top_handle());
+    q.pop();
+  }
+  print_data(q.size());
+}
+
+void tests_priority_queue_impl() {
+  print_header("priority_queue impl");
+
+  Chrono chrono("priority_queue impl");
+  chrono.begin();
+
+  priority_queue_impl_test<int>("int");
+  priority_queue_impl_test<float>("float");
+  priority_queue_impl_test<testing_struct>("testing_struct");
+  indexed_priority_queue_impl_test();
+
+  chrono.stop("total impl");
+  chrono.print();
+}
+
+template <typename T, std::size_t Arity>
+void priority_queue_arity_perf_test(Chrono &chrono, std::string const &name,
+                                    std::vector<int> const &data) {
+  typedef typename priority_queue_arity<T, Arity>::type queue;
+
+  queue q;
+  for (std::size_t i = 0; i < data.size(); ++i) {
+    q.push(T(data[i]));
+  }
+  chrono.stop(name + " push");
+
+  for (std::size_t i = 0; i < data.size(); ++i) {
+    q.pop();
+  }
+  chrono.stop(name + " pop");
+
+  std::vector<T> values(data.begin(), data.end());
+  chrono.stop(name + " setup");
+
+  queue bulk(values.begin(), values.end());
+  chrono.stop(name + " bulk construction");
+
+  // scheduler steady state: take the most urgent, requeue another one
+  std::size_t lower = 0;
+  for (std::size_t i = 0; i < data.size(); ++i) {
+    T const next(data[i]);
+    lower += next < bulk.top();
+    bulk.pop();
+    bulk.push(next);
+  }
+  chrono.stop(name + " pop push");
+  print_data(lower);
+}
+
+template <typename T>
+void priority_queue_perf_test(std::string const &type_name,
+                              std::vector<int> const &data) {
+  Chrono chrono(type_name);
+  chrono.begin();
+
+  priority_queue_arity_perf_test<T, 2>(chrono, "binary", data);
+  priority_queue_arity_perf_test<T, 4>(chrono, "4-ary", data);
+  priority_queue_arity_perf_test<T, 8>(chrono, "8-ary", data);
+
+  chrono.print();
+}
+
+void indexed_priority_queue_perf_test(std::vector<int> const &data) {
+  Chrono chrono("indexed");
+  chrono.begin();
+
+  indexed_priority_queue<int> q(data.size());
+  for (std::size_t i = 0; i < data.size(); ++i) {
+    q.push(i, data[i]);
+  }
+  chrono.stop("push");
+
+  // Dijkstra-like relaxations, mostly decreasing the value of a handle
+  for (std::size_t i = 0; i < data.size(); ++i) {
+    std::size_t const h = data[(i * 7) % data.size()] % data.size();
+    q.update(h, data[h] - int(i % 1000) - 1);
+  }
+  chrono.stop("update");
+
+  while (!q.empty()) {
+    q.pop();
+  }
+  chrono.stop("pop");
+
+  chrono.print();
+}
+
+void tests_priority_queue_perf() {
+  print_header("priority_queue perf");
+
+  Chrono chrono("priority_queue perf");
+  chrono.begin();
+
+  std::srand(42);
+  std::vector<int> data(PRIORITY_QUEUE_PERF_BASE_SIZE);
+  for (std::size_t i = 0; i < data.size(); ++i) {
+    data[i] = std::rand();
+  }
+
+  priority_queue_perf_test<int>("int", data);
+  priority_queue_perf_test<testing_struct>("testing_struct", data);
+  indexed_priority_queue_perf_test(data);
+
+  chrono.stop("total perf");
+  chrono.print();
+}
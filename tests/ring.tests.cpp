@@ -0,0 +1,447 @@
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <iostream>
+#include <new>
+#include <pthread.h>
+#include <sched.h>
+#include <sstream>
+#include <vector>
+
+#include "../ft/deque.hpp"
+#include "../ft/ring.hpp"
+
+#include "utils/chrono.hpp"
+#include "utils/latency.hpp"
+#include "utils/logger.hpp"
+#include "utils/testing_struct.hpp"
+
+// the baseline follows the build, the rings have no std counterpart
+#ifdef STD
+#define DEQ std::deque
+#else
+#define DEQ ft::deque
+#endif
+
+#define RING_PERF_BASE_SIZE 1000000 // 1 000 000
+#define RING_CAPACITY 1024
+#define RING_BATCH 32
+
+/*
+  What the pipeline stages were passing items through until now: a queue
+  behind one mutex.
+*/
+template <typename T> class locked_queue {
+  pthread_mutex_t m_mutex;
+  DEQ<T> m_queue;
+  std::size_t m_capacity;
+
+  locked_queue(locked_queue const &);
+  locked_queue &operator=(locked_queue const &);
+
+public:
+  locked_queue(std::size_t capacity) : m_capacity(capacity) {
+    pthread_mutex_init(&m_mutex, NULL);
+  }
+
+  ~locked_queue() { pthread_mutex_destroy(&m_mutex); }
+
+  std::size_t capacity() const { return m_capacity; }
+
+  template <typename InputIterator>
+  std::size_t try_push_n(InputIterator first, std::size_t n) {
+    pthread_mutex_lock(&m_mutex);
+    std::size_t count = 0;
+    for (; count < n && m_queue.size() < m_capacity; ++count, ++first) {
+      m_queue.push_back(*first);
+    }
+    pthread_mutex_unlock(&m_mutex);
+    return count;
+  }
+
+  template <typename OutputIterator>
+  std::size_t try_pop_n(OutputIterator out, std::size_t n) {
+    pthread_mutex_lock(&m_mutex);
+    std::size_t count = 0;
+    for (; count < n && !m_queue.empty(); ++count, ++out) {
+      *out = m_queue.front();
+      m_queue.pop_front();
+    }
+    pthread_mutex_unlock(&m_mutex);
+    return count;
+  }
+};
+
+static long ring_now() {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1000000000L + t.tv_nsec;
+}
+
+/*
+  Producers push the values [id * items, (id + 1) * items), consumers pop
+  until every produced item was seen. A full or empty queue yields the CPU so
+  the benchmark also makes progress with fewer cores than threads.
+*/
+template <typename Q> struct ring_worker {
+  Q *queue;
+  int id;
+  long items;
+  std::size_t batch;
+  long *remaining;
+  int const *start;
+  long sum;
+  Latency *latency;
+
+  // false when the run was called off, start is then negative
+  bool wait_start() const {
+    int s;
+    while (!(s = __atomic_load_n(start, __ATOMIC_ACQUIRE))) {
+      sched_yield();
+    }
+    return s > 0;
+  }
+
+  static void *produce(void *arg) {
+    ring_worker *w = static_cast<ring_worker *>(arg);
+    std::vector<long> buffer(w->batch);
+    if (!w->wait_start()) {
+      return NULL;
+    }
+    for (long i = 0; i < w->items;) {
+      std::size_t const n = std::min<long>(w->batch, w->items - i);
+      for (std::size_t j = 0; j < n; ++j) {
+        buffer[j] = w->latency ? ring_now() : w->id * w->items + i + j;
+      }
+      std::size_t pushed = 0;
+      while (pushed < n) {
+        std::size_t const k =
+            w->queue->try_push_n(&buffer[pushed], n - pushed);
+        if (k == 0) {
+          sched_yield();
+        }
+        pushed += k;
+      }
+      i += n;
+    }
+    return NULL;
+  }
+
+  static void *consume(void *arg) {
+    ring_worker *w = static_cast<ring_worker *>(arg);
+    std::vector<long> buffer(w->batch);
+    if (!w->wait_start()) {
+      return NULL;
+    }
+    while (__atomic_load_n(w->remaining, __ATOMIC_RELAXED) > 0) {
+      std::size_t const k = w->queue->try_pop_n(buffer.begin(), w->batch);
+      if (k == 0) {
+        sched_yield();
+        continue;
+      }
+      __atomic_fetch_sub(w->remaining, long(k), __ATOMIC_RELAXED);
+      long const now = w->latency ? ring_now() : 0;
+      for (std::size_t j = 0; j < k; ++j) {
+        if (w->latency) {
+          w->latency->record(now - buffer[j]);
+        } else {
+          w->sum += buffer[j];
+        }
+      }
+    }
+    return NULL;
+  }
+};
+
+/*
+  Runs producers and consumers over one queue, returns the sum of the popped
+  values. Latencies are recorded by the first consumer only. Every thread is
+  needed for the run to end, so when one cannot be started the others are
+  called off and -1 is returned.
+*/
+template <typename Q>
+long ring_run(Q &queue, int producers, int consumers, long items,
+              std::size_t batch, Latency *latency = NULL) {
+  int const threads = producers + consumers;
+  std::vector<pthread_t> ids(threads);
+  std::vector<ring_worker<Q> > workers(threads);
+  long remaining = items * producers;
+  int start = 0;
+  for (int t = 0; t < threads; ++t) {
+    bool const producer = t < producers;
+    ring_worker<Q> w = {&queue, t, items, batch, &remaining, &start, 0,
+                        producer || t == producers ? latency : NULL};
+    workers[t] = w;
+    if (pthread_create(&ids[t], NULL,
+                       producer ? &ring_worker<Q>::produce
+                                : &ring_worker<Q>::consume,
+                       &workers[t]) != 0) {
+      std::cerr << "could not start thread " << t << " of " << threads
+                << std::endl;
+      __atomic_store_n(&start, -1, __ATOMIC_RELEASE);
+      for (int s = 0; s < t; ++s) {
+        pthread_join(ids[s], NULL);
+      }
+      return -1;
+    }
+  }
+  __atomic_store_n(&start, 1, __ATOMIC_RELEASE);
+  long sum = 0;
+  for (int t = 0; t < threads; ++t) {
+    pthread_join(ids[t], NULL);
+    sum += workers[t].sum;
+  }
+  return sum;
+}
+
+template <typename Q> void ring_print_pop(Q &q, std::size_t n) {
+  std::vector<typename Q::value_type> out(n);
+  std::size_t const k = q.try_pop_n(out.begin(), n);
+  print_data(k);
+  for (std::size_t i = 0; i < k; ++i) {
+    print_data(out[i]);
+  }
+}
+
+template <typename Q> void ring_impl_test(Q &q) {
+  typedef typename Q::value_type T;
+  T value = T();
+
+  print_data(q.capacity());
+  print_data(q.empty());
+  print_data(q.try_pop(value));
+
+  int pushed = 0;
+  while (q.try_push(T(pushed))) {
+    ++pushed;
+  }
+  print_data(pushed);
+  print_data(q.size());
+
+  for (int i = 0; i < 3; ++i) {
+    print_data(q.try_pop(value));
+    print_data(value);
+  }
+
+  // wraps around the end of the buffer
+  std::vector<T> data;
+  for (int i = 0; i < 5; ++i) {
+    data.push_back(T(100 + i));
+  }
+  print_data(q.try_push_n(data.begin(), data.size()));
+  ring_print_pop(q, 4);
+  ring_print_pop(q, q.capacity());
+  print_data(q.empty());
+
+  print_data(q.try_push_n(data.begin(), data.size()));
+  // destroyed with elements left
+}
+
+// copies throw once the count of allowed ones runs out, -1 never does
+struct ring_throwing {
+  int value;
+
+  static int s_copies_left;
+
+  ring_throwing(int value = 0) : value(value) {}
+
+  ring_throwing(ring_throwing const &o) : value(o.value) {
+    if (s_copies_left == 0) {
+      throw std::bad_alloc();
+    }
+    if (s_copies_left > 0) {
+      --s_copies_left;
+    }
+  }
+};
+
+int ring_throwing::s_copies_left = -1;
+
+// the cells a throwing batch claimed are skipped, the ring keeps working
+void ring_throwing_push_impl_test() {
+  print_data("mpmc throwing push");
+  ft::mpmc_ring<ring_throwing> q(8);
+  std::vector<ring_throwing> data;
+  for (int i = 0; i < 5; ++i) {
+    data.push_back(ring_throwing(i));
+  }
+
+  ring_throwing::s_copies_left = 2;
+  try {
+    q.try_push_n(data.begin(), data.size());
+    print_data("no throw");
+  } catch (std::bad_alloc const &) {
+    print_data("thrown");
+  }
+  ring_throwing::s_copies_left = -1;
+
+  for (int round = 0; round < 2; ++round) {
+    std::vector<ring_throwing> out(q.capacity());
+    std::size_t const k = q.try_pop_n(out.begin(), out.size());
+    print_data(k);
+    for (std::size_t i = 0; i < k; ++i) {
+      print_data(out[i].value);
+    }
+    print_data(q.empty());
+    print_data(q.try_push_n(data.begin(), data.size()));
+  }
+}
+
+void ring_threads_impl_test(int producers, int consumers) {
+  long const items = 200000;
+  long const n = items * producers;
+  std::ostringstream name;
+  name << producers << " producers " << consumers << " consumers";
+  print_data(name.str());
+
+  ft::mpmc_ring<long> q(RING_CAPACITY);
+  print_data(ring_run(q, producers, consumers, items, 1) == n * (n - 1) / 2);
+  print_data(ring_run(q, producers, consumers, items, RING_BATCH) ==
+             n * (n - 1) / 2);
+  print_data(q.empty());
+}
+
+// values must come out in order with a single producer and consumer
+struct spsc_order_check {
+  ft::spsc_ring<long, RING_CAPACITY> *queue;
+  long items;
+  bool ordered;
+
+  static void *consume(void *arg) {
+    spsc_order_check *c = static_cast<spsc_order_check *>(arg);
+    long expected = 0;
+    long value;
+    while (expected < c->items) {
+      if (!c->queue->try_pop(value)) {
+        sched_yield();
+        continue;
+      }
+      c->ordered = c->ordered && value == expected;
+      ++expected;
+    }
+    return NULL;
+  }
+};
+
+void tests_ring_impl() {
+  print_header("ring impl");
+
+  Chrono chrono("ring impl");
+  chrono.begin();
+
+  {
+    print_data("spsc int");
+    ft::spsc_ring<int, 8> q;
+    ring_impl_test(q);
+  }
+  {
+    print_data("spsc testing_struct");
+    ft::spsc_ring<testing_struct, 8> q;
+    ring_impl_test(q);
+  }
+  {
+    print_data("mpmc int");
+    ft::mpmc_ring<int> q(6);
+    ring_impl_test(q);
+  }
+  {
+    print_data("mpmc testing_struct");
+    ft::mpmc_ring<testing_struct> q(8);
+    ring_impl_test(q);
+  }
+  ring_throwing_push_impl_test();
+
+  {
+    print_data("spsc order");
+    ft::spsc_ring<long, RING_CAPACITY> q;
+    spsc_order_check check = {&q, 200000, true};
+    pthread_t consumer;
+    if (pthread_create(&consumer, NULL, &spsc_order_check::consume,
+                       &check) != 0) {
+      std::cerr << "could not start the consumer" << std::endl;
+      check.ordered = false;
+    } else {
+      for (long i = 0; i < check.items;) {
+        if (q.try_push(i)) {
+          ++i;
+        } else {
+          sched_yield();
+        }
+      }
+      pthread_join(consumer, NULL);
+    }
+    print_data(check.ordered);
+  }
+
+  ring_threads_impl_test(1, 1);
+  ring_threads_impl_test(2, 2);
+  ring_threads_impl_test(4, 1);
+  ring_threads_impl_test(1, 4);
+
+  chrono.stop("total impl");
+  chrono.print();
+}
+
+/*
+  Throughput: RING_PERF_BASE_SIZE items in total are moved through the queue
+  by each producer/consumer configuration, element by element and in batches.
+*/
+template <typename Q>
+void ring_throughput_test(Chrono &chrono, std::string const &name,
+                          int producers, int consumers) {
+  Q q(RING_CAPACITY);
+  long const items = RING_PERF_BASE_SIZE / producers;
+  std::ostringstream label;
+  label << name << " " << producers << "p" << consumers << "c";
+
+  chrono.stop("setup " + label.str());
+  ring_run(q, producers, consumers, items, 1);
+  chrono.stop(label.str());
+  ring_run(q, producers, consumers, items, RING_BATCH);
+  chrono.stop(label.str() + " batch");
+}
+
+// the template capacity makes the spsc ring the odd one out
+template <std::size_t N> struct spsc_ring_long : ft::spsc_ring<long, N> {
+  spsc_ring_long(std::size_t) {}
+};
+
+// time from push to pop, the clock is read on both sides
+template <typename Q>
+void ring_latency_test(std::string const &name, int producers, int consumers,
+                       std::size_t batch) {
+  Q q(RING_CAPACITY);
+  long const items = RING_PERF_BASE_SIZE / 10 / producers;
+  std::ostringstream label;
+  label << name << " " << producers << "p" << consumers << "c batch " << batch;
+  Latency latency(label.str(), items * producers);
+  ring_run(q, producers, consumers, items, batch, &latency);
+  latency.print();
+}
+
+void tests_ring_perf() {
+  print_header("ring perf");
+
+  Chrono chrono("ring perf");
+  chrono.begin();
+
+  ring_throughput_test<spsc_ring_long<RING_CAPACITY> >(chrono, "spsc", 1, 1);
+  ring_throughput_test<ft::mpmc_ring<long> >(chrono, "mpmc", 1, 1);
+  ring_throughput_test<locked_queue<long> >(chrono, "mutex", 1, 1);
+  int const configs[][2] = {{2, 2}, {4, 4}, {4, 1}, {1, 4}};
+  for (std::size_t i = 0; i < sizeof(configs) / sizeof(*configs); ++i) {
+    ring_throughput_test<ft::mpmc_ring<long> >(chrono, "mpmc", configs[i][0],
+                                               configs[i][1]);
+    ring_throughput_test<locked_queue<long> >(chrono, "mutex", configs[i][0],
+                                              configs[i][1]);
+  }
+
+  chrono.stop("total perf");
+  chrono.print();
+
+  ring_latency_test<spsc_ring_long<RING_CAPACITY> >("spsc", 1, 1, 1);
+  ring_latency_test<ft::mpmc_ring<long> >("mpmc", 1, 1, 1);
+  ring_latency_test<locked_queue<long> >("mutex", 1, 1, 1);
+  ring_latency_test<ft::mpmc_ring<long> >("mpmc", 4, 4, 1);
+  ring_latency_test<locked_queue<long> >("mutex", 4, 4, 1);
+}
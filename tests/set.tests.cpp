@@ -1,9 +1,17 @@
+#include <algorithm>
 #include <cassert>
+#include <sstream>
+#include <string>
+#include <utility>
 #include <vector>
 
+#include "utils/bench.hpp"
 #include "utils/chrono.hpp"
+#include "utils/counting_compare.hpp"
 #include "utils/logger.hpp"
 #include "utils/testing_struct.hpp"
+#include "utils/tracking_allocator.hpp"
+#include "utils/workload.hpp"
 
 #ifdef STD
 #include <set>
@@ -11,11 +19,52 @@
 #define SWAP std::swap
 #else
 #include "../ft/set.hpp"
+#include "utils/tree_stats.hpp"
 #define SET ft::set
 #define SWAP ft::swap
 #endif
 
+#ifdef STD
+template <typename S, typename A1>
+std::pair<typename S::iterator, bool> set_emplace(S &s, A1 const &a1) {
+  return s.insert(typename S::value_type(a1));
+}
+
+template <typename S, typename A1, typename A2, typename A3>
+std::pair<typename S::iterator, bool> set_emplace(S &s, A1 const &a1,
+                                                  A2 const &a2, A3 const &a3) {
+  return s.insert(typename S::value_type(a1, a2, a3));
+}
+
+template <typename S, typename A1>
+typename S::iterator set_emplace_hint(S &s, typename S::iterator pos,
+                                      A1 const &a1) {
+  return s.insert(pos, typename S::value_type(a1));
+}
+#else
+template <typename S, typename A1>
+ft::pair<typename S::iterator, bool> set_emplace(S &s, A1 const &a1) {
+  return s.emplace(a1);
+}
+
+template <typename S, typename A1, typename A2, typename A3>
+ft::pair<typename S::iterator, bool> set_emplace(S &s, A1 const &a1,
+                                                 A2 const &a2, A3 const &a3) {
+  return s.emplace(a1, a2, a3);
+}
+
+template <typename S, typename A1>
+typename S::iterator set_emplace_hint(S &s, typename S::iterator pos,
+                                      A1 const &a1) {
+  return s.emplace_hint(pos, a1);
+}
+#endif
+
 #define SET_PERF_BASE_SIZE 1000000 // 1 000 000
+#define SET_WORKLOAD_SIZE 65536
+#define SET_TREE_STATS_SIZE 100000 // 100 000
+#define SET_COMPARISONS_SIZE 100000 // 100 000
+#define SET_TRAVERSAL_WIDTH 64
 
 #define SET_PRINT_STATE(set) set_print_state(set, #set)
 template <typename T> void set_print_state(SET<T> v, std::string const &name) {
@@ -130,6 +179,15 @@ template <typename T> void set_impl_test(std::string const &type_name) {
   range_constructor.insert(data2.begin(), data2.end());
   set_print_state(range_constructor, "insert range");
 
+  print_data(*set_emplace(range_constructor, 60).first);
+  print_data(set_emplace(range_constructor, 60).second);
+  set_print_state(range_constructor, "emplace");
+
+  print_data(*set_emplace_hint(range_constructor, range_constructor.end(), 61));
+  print_data(*set_emplace_hint(range_constructor, range_constructor.begin(),
+                               61));
+  set_print_state(range_constructor, "emplace hint");
+
   range_constructor.erase(range_constructor.begin());
   set_print_state(range_constructor, "erase position");
 
@@ -171,8 +229,49 @@ template <typename T> void set_impl_test(std::string const &type_name) {
   set_print_state(two, "swap 2 two");
 }
 
+template <typename S> struct set_find_case : bench_case {
+  S const &s;
+  typename S::key_type key;
+
+  set_find_case(S const &s, typename S::key_type const &key)
+      : s(s), key(key) {}
+
+  void operator()(std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      do_not_optimize(s.find(key));
+    }
+  }
+};
+
+enum set_hint { SET_NO_HINT, SET_WRONG_HINT, SET_CORRECT_HINT };
+
+// one insert and the erase undoing it per operation, the size stays constant
+template <typename S> struct set_insert_erase_case : bench_case {
+  S &s;
+  typename S::value_type value;
+  set_hint hint;
+
+  set_insert_erase_case(S &s, typename S::value_type const &value,
+                        set_hint hint)
+      : s(s), value(value), hint(hint) {}
+
+  void operator()(std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      if (hint == SET_NO_HINT) {
+        s.insert(value);
+      } else if (hint == SET_WRONG_HINT) {
+        s.insert(s.begin(), value);
+      } else {
+        s.insert(--s.end(), value);
+      }
+      s.erase(value);
+    }
+  }
+};
+
 template <typename T> void set_perf_test(std::string const &type_name) {
   Chrono chrono(type_name);
+  Bench bench("set", type_name);
   chrono.begin();
 
   std::vector<T> v1;
@@ -188,32 +287,27 @@ template <typename T> void set_perf_test(std::string const &type_name) {
   SET<T> s(v1.rbegin(), v1.rend());
   chrono.stop("fill constructor");
 
-  s.insert(SET_PERF_BASE_SIZE + 1);
-  chrono.stop("insert value");
-
-  s.insert(s.begin(), SET_PERF_BASE_SIZE + 2);
-  chrono.stop("insert value wrong hint");
-
-  s.insert(--s.end(), SET_PERF_BASE_SIZE + 3);
-  chrono.stop("insert value correct hint");
-
   s.insert(v2.rbegin(), v2.rend());
   chrono.stop("insert range");
-
-  s.find(*s.begin());
-  chrono.stop("find begin");
-
-  s.find(SET_PERF_BASE_SIZE);
-  chrono.stop("find middle");
-
-  s.find(*--s.end());
-  chrono.stop("find end");
-
-  s.erase(++s.begin());
-  chrono.stop("erase position");
-
-  s.erase(SET_PERF_BASE_SIZE);
-  chrono.stop("erase value");
+  bench.size(s.size());
+
+  set_insert_erase_case<SET<T> > insert_value(s, SET_PERF_BASE_SIZE * 2 + 1,
+                                              SET_NO_HINT);
+  bench.run("insert erase value", insert_value);
+  set_insert_erase_case<SET<T> > wrong_hint(s, SET_PERF_BASE_SIZE * 2 + 1,
+                                            SET_WRONG_HINT);
+  bench.run("insert erase value wrong hint", wrong_hint);
+  set_insert_erase_case<SET<T> > correct_hint(s, SET_PERF_BASE_SIZE * 2 + 1,
+                                              SET_CORRECT_HINT);
+  bench.run("insert erase value correct hint", correct_hint);
+
+  set_find_case<SET<T> > find_begin(s, *s.begin());
+  bench.run("find begin", find_begin);
+  set_find_case<SET<T> > find_middle(s, SET_PERF_BASE_SIZE);
+  bench.run("find middle", find_middle);
+  set_find_case<SET<T> > find_end(s, *--s.end());
+  bench.run("find end", find_end);
+  chrono.stop("single operations");
 
   typename SET<T>::iterator end = s.begin();
   for (int i = 0; i < SET_PERF_BASE_SIZE; ++i) {
@@ -226,8 +320,513 @@ template <typename T> void set_perf_test(std::string const &type_name) {
   chrono.stop("clear");
 
   chrono.print();
+  bench.print();
 }
 
+// finds cycling through keys, every one in the set
+template <typename S> struct set_find_random_case : bench_case {
+  S const &s;
+  std::vector<typename S::key_type> const &keys;
+  std::size_t next;
+
+  set_find_random_case(S const &s,
+                       std::vector<typename S::key_type> const &keys)
+      : s(s), keys(keys), next(0) {}
+
+  void operator()(std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      do_not_optimize(s.find(keys[next]));
+      if (++next == keys.size()) {
+        next = 0;
+      }
+    }
+  }
+};
+
+// erases a key and inserts it back, the size stays constant
+template <typename S> struct set_erase_insert_random_case : bench_case {
+  S &s;
+  std::vector<typename S::key_type> const &keys;
+  std::size_t next;
+
+  set_erase_insert_random_case(S &s,
+                               std::vector<typename S::key_type> const &keys)
+      : s(s), keys(keys), next(0) {}
+
+  void operator()(std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      s.erase(keys[next]);
+      s.insert(keys[next]);
+      if (++next == keys.size()) {
+        next = 0;
+      }
+    }
+  }
+};
+
+// one increment per operation, wrapping around at the end
+template <typename S> struct set_iterate_case : bench_case {
+  S const &s;
+  typename S::const_iterator it;
+
+  set_iterate_case(S const &s) : s(s), it(s.begin()) {}
+
+  void operator()(std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      do_not_optimize(*it);
+      if (++it == s.end()) {
+        it = s.begin();
+      }
+    }
+  }
+};
+
+// one decrement per operation, wrapping around at the beginning
+template <typename S> struct set_reverse_iterate_case : bench_case {
+  S const &s;
+  typename S::const_iterator it;
+
+  set_reverse_iterate_case(S const &s) : s(s), it(s.end()) {}
+
+  void operator()(std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      if (it == s.begin()) {
+        it = s.end();
+      }
+      --it;
+      do_not_optimize(*it);
+    }
+  }
+};
+
+// one lower_bound..upper_bound scan per operation, over [lows[i], highs[i]]
+template <typename S> struct set_range_scan_case : bench_case {
+  S const &s;
+  std::vector<typename S::key_type> const &lows;
+  std::vector<typename S::key_type> const &highs;
+  std::size_t next;
+
+  set_range_scan_case(S const &s,
+                      std::vector<typename S::key_type> const &lows,
+                      std::vector<typename S::key_type> const &highs)
+      : s(s), lows(lows), highs(highs), next(0) {}
+
+  void operator()(std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      typename S::const_iterator it = s.lower_bound(lows[next]);
+      typename S::const_iterator const last = s.upper_bound(highs[next]);
+      for (; it != last; ++it) {
+        do_not_optimize(*it);
+      }
+      if (++next == lows.size()) {
+        next = 0;
+      }
+    }
+  }
+};
+
+// inserts the stream into the emptied set, one key per operation
+template <typename S> struct set_insert_stream_case : bench_case {
+  S &s;
+  std::vector<typename S::key_type> const &keys;
+
+  set_insert_stream_case(S &s, std::vector<typename S::key_type> const &keys)
+      : s(s), keys(keys) {}
+
+  void setup(std::size_t) { s.clear(); }
+
+  void operator()(std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      s.insert(keys[i]);
+    }
+  }
+};
+
+/*
+  Reads are finds, writes erase the key when it is there and insert it
+  otherwise, so the size stays around where it started.
+*/
+template <typename S> struct set_mix_case : bench_case {
+  S &s;
+  std::vector<Workload::operation> const &operations;
+  std::vector<typename S::key_type> const &keys;
+  std::size_t next;
+
+  set_mix_case(S &s, std::vector<Workload::operation> const &operations,
+               std::vector<typename S::key_type> const &keys)
+      : s(s), operations(operations), keys(keys), next(0) {}
+
+  void operator()(std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      if (operations[next].read) {
+        do_not_optimize(s.find(keys[next]));
+      } else if (s.erase(keys[next]) == 0) {
+        s.insert(keys[next]);
+      }
+      if (++next == operations.size()) {
+        next = 0;
+      }
+    }
+  }
+};
+
+// converted once, out of the timed loops
+template <typename T>
+std::vector<T> set_workload_keys(std::vector<Workload::operation> const &ops) {
+  std::vector<T> keys;
+  keys.reserve(ops.size());
+  for (std::size_t i = 0; i < ops.size(); ++i) {
+    keys.push_back(T(ops[i].key));
+  }
+  return keys;
+}
+
+// every distribution: filling an empty set, finds, then mixed traffic
+template <typename T>
+void set_workload_perf_test(std::string const &type_name) {
+  Bench bench("set", type_name);
+  bench.size(SET_WORKLOAD_SIZE);
+  unsigned const mixes[] = {95, 50};
+
+  for (int d = 0; d < Workload::distribution_count; ++d) {
+    Workload::distribution const dist = Workload::distribution(d);
+    std::string const name = Workload::name(dist);
+    std::vector<Workload::operation> const stream =
+        Workload(dist, SET_WORKLOAD_SIZE).operations(SET_WORKLOAD_SIZE, 0);
+    std::vector<T> const keys = set_workload_keys<T>(stream);
+
+    SET<T> s;
+    set_insert_stream_case<SET<T> > insert(s, keys);
+    bench.run(name + " insert", insert, keys.size());
+    set_find_random_case<SET<T> > find(s, keys);
+    bench.run(name + " find", find);
+
+    for (std::size_t m = 0; m < sizeof(mixes) / sizeof(*mixes); ++m) {
+      std::vector<Workload::operation> const ops =
+          Workload(dist, SET_WORKLOAD_SIZE, 43)
+              .operations(SET_WORKLOAD_SIZE, mixes[m]);
+      std::vector<T> const mix_keys = set_workload_keys<T>(ops);
+      set_mix_case<SET<T> > mix(s, ops, mix_keys);
+      std::ostringstream label;
+      label << name << " " << mixes[m] << "/" << 100 - mixes[m];
+      bench.run(label.str(), mix);
+    }
+  }
+  bench.print();
+}
+
+/*
+  In-order traversal where the memory order of the nodes matches the key
+  order (sorted inserts), does not (scattered inserts), or used to before
+  half of the keys were erased and inserted back (churned). Run with
+  --counters to see the cache misses of the iterator increments.
+*/
+template <typename T>
+void set_traversal_perf_test(std::string const &type_name) {
+  char const *const layouts[] = {"sorted", "scattered", "churned"};
+  // from cache resident to far out, unless a sweep was asked for
+  std::vector<std::size_t> const sizes = Bench::sweep_sizes_or(10, 20, 5);
+
+  for (std::size_t l = 0; l < sizeof(layouts) / sizeof(*layouts); ++l) {
+    Bench bench("set", type_name + " " + layouts[l]);
+    for (std::size_t i = 0; i < sizes.size(); ++i) {
+      std::vector<int> order;
+      for (std::size_t k = 0; k < sizes[i]; ++k) {
+        order.push_back(int(k));
+      }
+      std::random_shuffle(order.begin(), order.end());
+      std::vector<T> lows;
+      std::vector<T> highs;
+      for (std::size_t k = 0; k < order.size(); ++k) {
+        lows.push_back(T(order[k]));
+        highs.push_back(T(order[k] + SET_TRAVERSAL_WIDTH - 1));
+      }
+
+      SET<T> s;
+      for (std::size_t k = 0; k < sizes[i]; ++k) {
+        s.insert(T(l == 1 ? order[k] : int(k)));
+      }
+      if (l == 2) {
+        for (std::size_t k = 0; k < order.size() / 2; ++k) {
+          s.erase(lows[k]);
+        }
+        s.insert(lows.begin(), lows.begin() + order.size() / 2);
+      }
+      bench.size(s.size());
+
+      set_iterate_case<SET<T> > forward(s);
+      bench.run("forward", forward);
+      set_reverse_iterate_case<SET<T> > reverse(s);
+      bench.run("reverse", reverse);
+      set_range_scan_case<SET<T> > range(s, lows, highs);
+      std::ostringstream label;
+      label << "range " << SET_TRAVERSAL_WIDTH;
+      bench.run(label.str(), range);
+    }
+    bench.print_curves();
+  }
+}
+
+/*
+  Same operations at every size of the sweep, the keys are inserted and
+  looked up in random order so the nodes are spread over the heap as they
+  are after a real workload.
+*/
+template <typename T> void set_sweep_perf_test(std::string const &type_name) {
+  Bench bench("set", type_name);
+  std::vector<std::size_t> const &sizes = Bench::sweep_sizes();
+
+  for (std::size_t i = 0; i < sizes.size(); ++i) {
+    std::vector<T> keys;
+    keys.reserve(sizes[i]);
+    for (std::size_t k = 0; k < sizes[i]; ++k) {
+      keys.push_back(T(int(k)));
+    }
+    std::random_shuffle(keys.begin(), keys.end());
+    SET<T> s(keys.begin(), keys.end());
+    bench.size(s.size());
+
+    set_find_random_case<SET<T> > find(s, keys);
+    bench.run("find random", find);
+    set_erase_insert_random_case<SET<T> > erase_insert(s, keys);
+    bench.run("erase insert random", erase_insert);
+    set_iterate_case<SET<T> > iterate(s);
+    bench.run("iterate", iterate);
+  }
+  bench.print_curves();
+}
+
+void set_emplace_perf_test() {
+  Chrono chrono("testing_struct emplace");
+  std::string const str(64, 'x');
+  chrono.begin();
+
+  SET<testing_struct> s1;
+  for (int i = 0; i < SET_PERF_BASE_SIZE; ++i) {
+    s1.insert(testing_struct(i, 'c', str));
+  }
+  chrono.stop("insert temporary");
+
+  SET<testing_struct> s2;
+  for (int i = 0; i < SET_PERF_BASE_SIZE; ++i) {
+    set_emplace(s2, i, 'c', str);
+  }
+  chrono.stop("emplace");
+
+  for (int i = 0; i < SET_PERF_BASE_SIZE; ++i) {
+    set_emplace(s2, i, 'c', str);
+  }
+  chrono.stop("emplace existing");
+
+  chrono.print();
+}
+
+// the nodes come from the rebound allocator, sharing the same stats
+void set_allocator_impl_test() {
+  typedef SET<int, std::less<int>, tracking_allocator<int> > set;
+
+  print_data("tracking allocator");
+  allocation_stats stats;
+  {
+    tracking_allocator<int> const alloc(&stats);
+    set s(std::less<int>(), alloc);
+    for (int i = 0; i < 100; ++i) {
+      s.insert(i);
+      s.insert(i);
+    }
+    print_data(stats.allocations());
+    set copy(s);
+    copy.erase(copy.begin(), copy.find(50));
+    print_data(copy.get_allocator().stats() == &stats);
+    print_data(stats.allocations());
+    print_data(stats.deallocations());
+  }
+  print_data(stats.allocations() == stats.deallocations());
+  print_data(stats.live());
+}
+
+void set_compare_impl_test() {
+  typedef SET<int, counting_compare<int> > set;
+
+  print_data("counting compare");
+  std::size_t count = 0;
+  set s((counting_compare<int>(&count)));
+  for (int i = 0; i < 100; ++i) {
+    s.insert((i * 37) % 100);
+  }
+  print_data(count > 0);
+  print_data(s.key_comp().count() == &count);
+  set copy(s);
+  print_data(copy.key_comp().count() == &count);
+  std::size_t const before = count;
+  print_data(*copy.find(42));
+  print_data(count > before);
+  print_data(copy.size());
+  for (set::const_iterator it = copy.begin(); it != copy.end(); ++it) {
+    print_data(*it);
+  }
+}
+
+// keys of the comparison tests, the strings share a prefix as paths do
+template <typename T> T set_comparison_key(std::size_t i) { return T(i); }
+
+template <> std::string set_comparison_key<std::string>(std::size_t i) {
+  std::ostringstream key;
+  key << "/var/lib/records/" << i;
+  return key.str();
+}
+
+/*
+  Comparator calls per operation, where a comparator heavy key spends its
+  time: sorted input with and without an end() hint and built from a range
+  should cost far less than scattered inserts.
+*/
+template <typename T>
+void set_comparisons_perf_test(std::string const &type_name) {
+  typedef counting_compare<T> compare;
+  typedef SET<T, compare> set;
+  std::size_t const n = SET_COMPARISONS_SIZE;
+
+  std::vector<T> sorted;
+  std::vector<T> scattered;
+  for (std::size_t i = 0; i < n; ++i) {
+    sorted.push_back(set_comparison_key<T>(i));
+    scattered.push_back(set_comparison_key<T>((i * 7919) % n));
+  }
+  // the strings do not sort like the numbers they hold
+  std::sort(sorted.begin(), sorted.end());
+
+  std::size_t count = 0;
+  compare const comp(&count);
+  Comparisons comparisons("set " + type_name, &count);
+  comparisons.begin();
+
+  set s(comp);
+  for (std::size_t i = 0; i < n; ++i) {
+    s.insert(scattered[i]);
+  }
+  comparisons.stop("scattered insert", n);
+  for (std::size_t i = 0; i < n; ++i) {
+    do_not_optimize(s.find(scattered[i]));
+  }
+  comparisons.stop("find", n);
+  for (std::size_t i = 0; i < n; ++i) {
+    s.insert(scattered[i]);
+  }
+  comparisons.stop("insert existing", n);
+  for (std::size_t i = 0; i < n; i += 2) {
+    s.erase(scattered[i]);
+  }
+  comparisons.stop("erase", n / 2);
+
+  set in_order(comp);
+  for (std::size_t i = 0; i < n; ++i) {
+    in_order.insert(sorted[i]);
+  }
+  comparisons.stop("sorted insert", n);
+
+  set hinted(comp);
+  for (std::size_t i = 0; i < n; ++i) {
+    hinted.insert(hinted.end(), sorted[i]);
+  }
+  comparisons.stop("sorted insert end hint", n);
+
+  set range(sorted.begin(), sorted.end(), comp);
+  comparisons.stop("sorted range constructor", n);
+  comparisons.print();
+}
+
+template <typename T>
+void set_allocation_perf_test(std::string const &type_name) {
+  typedef SET<T, std::less<T>, tracking_allocator<T> > set;
+  std::size_t const n = SET_PERF_BASE_SIZE;
+
+  Allocations allocations("set " + type_name);
+  allocations.begin();
+  {
+    set s;
+    for (std::size_t i = 0; i < n; ++i) {
+      s.insert(T((i * 7919) % n));
+    }
+    allocations.stop("insert", n);
+    allocations.footprint("insert", s.size(), sizeof(T));
+
+    for (std::size_t i = 0; i < n; ++i) {
+      s.insert(T(i));
+    }
+    allocations.stop("insert existing", n);
+
+    set copy(s);
+    allocations.stop("copy constructor", n);
+
+    for (std::size_t i = 0; i < n; i += 2) {
+      s.erase(T(i));
+    }
+    allocations.stop("erase", n / 2);
+
+    copy.clear();
+    allocations.stop("clear", n);
+  }
+  allocations.stop("destruction", n / 2);
+  allocations.print();
+}
+
+#ifndef STD
+/*
+  Shape of the tree and rebalancing work for sorted and scattered insertion
+  orders, then scattered erases. ft only, std has no introspection.
+*/
+template <typename T> void set_tree_stats_perf_test(std::string const &type) {
+  std::size_t const n = SET_TREE_STATS_SIZE;
+
+  TreeStats stats("set " + type);
+  SET<T> sorted;
+  stats.begin();
+  for (std::size_t i = 0; i < n; ++i) {
+    sorted.insert(T(i));
+  }
+  stats.stop("sorted insert", n, sorted.tree_stats());
+
+  SET<T> scattered;
+  stats.begin();
+  for (std::size_t i = 0; i < n; ++i) {
+    scattered.insert(T((i * 7919) % n));
+  }
+  stats.stop("scattered insert", n, scattered.tree_stats());
+  for (std::size_t i = 0; i < n / 2; ++i) {
+    scattered.erase(T((i * 104729) % n));
+  }
+  stats.stop("scattered erase", n / 2, scattered.tree_stats());
+  stats.print();
+}
+
+// shapes known in advance, checked silently as std prints nothing here
+void set_tree_stats_impl_test() {
+  SET<int> s;
+  ft::Rb_tree_stats stats = s.tree_stats();
+  assert(stats.size == 0 && stats.height == 0 && stats.black_height == 0);
+  assert(stats.average_depth == 0 && stats.average_search_depth == 0);
+
+  // sorted inserts lean right: 2 (1, 4 (3, 6 (5, 7)))
+  for (int i = 1; i <= 7; ++i) {
+    s.insert(i);
+  }
+  stats = s.tree_stats();
+  assert(stats.size == 7 && stats.height == 4 && stats.black_height == 2);
+  assert(stats.average_search_depth == 26.0 / 8);
+
+  // medians first give the perfect tree, every lookup compares three keys
+  int const medians[] = {4, 2, 6, 1, 3, 5, 7};
+  SET<int> perfect(medians, medians + 7);
+  stats = perfect.tree_stats();
+  assert(stats.size == 7 && stats.height == 3 && stats.black_height == 2);
+  assert(stats.average_search_depth == 3);
+
+  s.clear();
+  assert(s.tree_stats().size == 0 && s.tree_stats().height == 0);
+}
+#endif
+
 void tests_set_impl() {
   print_header("set impl");
 
@@ -237,6 +836,11 @@ void tests_set_impl() {
   set_impl_test<int>("int");
   set_impl_test<float>("float");
   set_impl_test<testing_struct>("testing_struct");
+  set_allocator_impl_test();
+  set_compare_impl_test();
+#ifndef STD
+  set_tree_stats_impl_test();
+#endif
 
   chrono.stop("total impl");
   chrono.print();
@@ -248,8 +852,35 @@ void tests_set_perf() {
   Chrono chrono("set perf");
   chrono.begin();
 
+  if (!Bench::sweep_sizes().empty()) {
+    set_sweep_perf_test<int>("int");
+    set_sweep_perf_test<testing_struct>("testing_struct");
+    set_traversal_perf_test<int>("int");
+    chrono.stop("total sweep");
+    chrono.print();
+    return;
+  }
+
   set_perf_test<int>("int");
   set_perf_test<testing_struct>("testing_struct");
+  set_emplace_perf_test();
+  chrono.stop("setup workloads");
+  set_workload_perf_test<int>("int");
+  set_workload_perf_test<testing_struct>("testing_struct");
+  chrono.stop("workloads");
+  set_traversal_perf_test<int>("int");
+  chrono.stop("traversal");
+#ifndef STD
+  set_tree_stats_perf_test<int>("int");
+  set_tree_stats_perf_test<testing_struct>("testing_struct");
+  chrono.stop("tree stats");
+#endif
+  set_comparisons_perf_test<int>("int");
+  set_comparisons_perf_test<testing_struct>("testing_struct");
+  set_comparisons_perf_test<std::string>("string");
+  chrono.stop("comparisons");
+  set_allocation_perf_test<int>("int");
+  set_allocation_perf_test<testing_struct>("testing_struct");
 
   chrono.stop("total perf");
   chrono.print();
@@ -7,10 +7,12 @@
 #include <stack>
 #include <vector>
 
+#include "../ft/deque.hpp"
 #include "../ft/stack.hpp"
 #include "../ft/vector.hpp"
 
 #include "utils/chrono.hpp"
+#include "utils/latency.hpp"
 #include "utils/logger.hpp"
 #include "utils/testing_struct.hpp"
 
@@ -20,6 +22,8 @@
 #define STK ft::stack
 #endif
 
+#define STACK_PERF_BASE_SIZE 1000000 // 1 000 000
+
 template <typename S>
 void stack_impl_test(std::string const &container_name, S s) {
   print_data(container_name);
@@ -67,6 +71,7 @@ template <typename T> void stack_impl_test(std::string const &type_name) {
   print_data(type_name);
 
   stack_impl_test("ft vector", STK<T, ft::vector<T> >());
+  stack_impl_test("ft deque", STK<T, ft::deque<T> >());
   stack_impl_test("std vector", STK<T, std::vector<T> >());
   stack_impl_test("std list", STK<T, std::list<T> >());
   stack_impl_test("std deque", STK<T, std::deque<T> >());
@@ -84,4 +89,82 @@ void tests_stack_impl() {
 
   chrono.stop("total impl");
   chrono.print();
-}
\ No newline at end of file
+}
+
+template <typename S>
+void stack_container_perf_test(std::string const &container_name) {
+  typedef typename S::value_type T;
+
+  Chrono chrono(container_name);
+  chrono.begin();
+
+  S s;
+  for (int i = 0; i < STACK_PERF_BASE_SIZE; ++i) {
+    s.push(T(i));
+  }
+  chrono.stop("push");
+
+  std::size_t greater = 0;
+  for (int i = 0; i < STACK_PERF_BASE_SIZE; ++i) {
+    greater += T(i) < s.top();
+  }
+  chrono.stop("top");
+
+  for (int i = 0; i < STACK_PERF_BASE_SIZE; ++i) {
+    s.pop();
+  }
+  chrono.stop("pop");
+
+  // work list usage: the stack stays small and is refilled all the time
+  for (int i = 0; i < STACK_PERF_BASE_SIZE; ++i) {
+    s.push(T(i));
+    s.push(T(i));
+    s.pop();
+    if (i % 4 == 0) {
+      s.pop();
+    }
+  }
+  chrono.stop("interleaved push pop");
+
+  chrono.print();
+  print_data(greater);
+
+  Latency push(container_name + " interleaved push", STACK_PERF_BASE_SIZE);
+  Latency pop(container_name + " interleaved pop", STACK_PERF_BASE_SIZE);
+  for (int i = 0; i < STACK_PERF_BASE_SIZE; ++i) {
+    push.begin();
+    s.push(T(i));
+    push.stop();
+    if (i % 2 == 0) {
+      pop.begin();
+      s.pop();
+      pop.stop();
+    }
+  }
+  push.print();
+  pop.print();
+}
+
+template <typename T> void stack_perf_test(std::string const &type_name) {
+  print_data(type_name);
+
+  stack_container_perf_test<STK<T, ft::vector<T> > >(type_name + " ft vector");
+  stack_container_perf_test<STK<T, ft::deque<T> > >(type_name + " ft deque");
+  stack_container_perf_test<STK<T, std::vector<T> > >(type_name +
+                                                      " std vector");
+  stack_container_perf_test<STK<T, std::list<T> > >(type_name + " std list");
+  stack_container_perf_test<STK<T, std::deque<T> > >(type_name + " std deque");
+}
+
+void tests_stack_perf() {
+  print_header("stack perf");
+
+  Chrono chrono("stack perf");
+  chrono.begin();
+
+  stack_perf_test<int>("int");
+  stack_perf_test<testing_struct>("testing_struct");
+
+  chrono.stop("total perf");
+  chrono.print();
+}
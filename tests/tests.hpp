@@ -18,6 +18,19 @@ void tests_vector_impl();
 void tests_vector_perf();
 
 void tests_stack_impl();
+void tests_stack_perf();
+
+void tests_concurrent_stack_impl();
+void tests_concurrent_stack_perf();
+
+void tests_deque_impl();
+void tests_deque_perf();
+
+void tests_ring_impl();
+void tests_ring_perf();
+
+void tests_priority_queue_impl();
+void tests_priority_queue_perf();
 
 void tests_set_impl();
 void tests_set_perf();
@@ -25,4 +38,13 @@ void tests_set_perf();
 void tests_map_impl();
 void tests_map_perf();
 
+void tests_intrusive_tree_impl();
+void tests_intrusive_tree_perf();
+
+void tests_interval_map_impl();
+void tests_interval_map_perf();
+
+void tests_trace_impl();
+void tests_trace_perf();
+
 #endif
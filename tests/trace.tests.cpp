@@ -0,0 +1,241 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <pthread.h>
+#include <set>
+#include <vector>
+
+#include "../ft/trace.hpp"
+
+#ifndef STD
+#include "../ft/map.hpp"
+#include "../ft/vector.hpp"
+#endif
+
+#include "utils/bench.hpp"
+#include "utils/chrono.hpp"
+#include "utils/logger.hpp"
+
+// the recorder is exercised directly, the same way in both builds
+#define TRACE_THREADS 4
+#define TRACE_THREAD_EVENTS 1000
+#define TRACE_WORKLOAD_SIZE 10000 // 10 000, the ring keeps every event
+
+// apart from the ring of the process, which --trace dumps at exit
+static ft::trace_ring s_ring;
+
+static void *trace_record_thread(void *) {
+  for (int i = 0; i < TRACE_THREAD_EVENTS; ++i) {
+    s_ring.record(ft::TRACE_NODE_ALLOCATE, i);
+  }
+  return NULL;
+}
+
+static void trace_print_events(std::vector<ft::trace_event> const &events) {
+  for (std::size_t i = 0; i < events.size(); ++i) {
+    print_data(ft::trace_event_name(ft::trace_event_type(events[i].type)));
+    print_data(events[i].size);
+    print_data(events[i].thread);
+  }
+}
+
+void trace_ring_impl_test() {
+  print_data("ring trace");
+
+  s_ring.clear();
+  print_data(s_ring.recorded());
+  s_ring.record(ft::TRACE_VECTOR_REALLOCATE, 64);
+  s_ring.record(ft::TRACE_INSERT_REBALANCE, 2);
+  s_ring.record(ft::TRACE_ERASE_REBALANCE, 0);
+  print_data(s_ring.recorded());
+
+  std::vector<ft::trace_event> events(8);
+  events.resize(s_ring.read(&events[0], events.size()));
+  trace_print_events(events);
+  print_data(events[0].timestamp <= events[1].timestamp &&
+             events[1].timestamp <= events[2].timestamp);
+
+  // the most recent events, oldest first
+  events.resize(2);
+  events.resize(s_ring.read(&events[0], events.size()));
+  trace_print_events(events);
+
+  // wraps around, the oldest events are dropped
+  s_ring.clear();
+  for (std::size_t i = 0; i < FT_TRACE_CAPACITY + 10; ++i) {
+    s_ring.record(ft::TRACE_NODE_DEALLOCATE, i);
+  }
+  print_data(s_ring.recorded());
+  events.resize(FT_TRACE_CAPACITY + 10);
+  events.resize(s_ring.read(&events[0], events.size()));
+  print_data(events.size() == FT_TRACE_CAPACITY);
+  print_data(events.front().size);
+  print_data(events.back().size == FT_TRACE_CAPACITY + 9);
+}
+
+void trace_dump_impl_test() {
+  print_data("dump");
+
+  char const *const path = "trace.impl.bin";
+  s_ring.clear();
+  for (int i = 0; i < 5; ++i) {
+    s_ring.record(ft::TRACE_VECTOR_REALLOCATE, 1 << i);
+  }
+  print_data(s_ring.dump(path));
+
+  std::ifstream in(path, std::ios::binary);
+  ft::trace_ring::header h;
+  in.read(reinterpret_cast<char *>(&h), sizeof(h));
+  print_data(h.magic);
+  print_data(h.version);
+  print_data(h.event_size == sizeof(ft::trace_event));
+  print_data(h.count);
+  print_data(h.dropped);
+  std::vector<ft::trace_event> events(h.count);
+  in.read(reinterpret_cast<char *>(&events[0]),
+          h.count * sizeof(ft::trace_event));
+  print_data(in.gcount() == std::streamsize(h.count * h.event_size));
+  trace_print_events(events);
+  in.close();
+  std::remove(path);
+
+  print_data(s_ring.dump("/nonexistent/trace.bin"));
+}
+
+void trace_threads_impl_test() {
+  print_data("threads");
+
+  s_ring.clear();
+  std::vector<pthread_t> ids(TRACE_THREADS);
+  int started = 0;
+  for (; started < TRACE_THREADS; ++started) {
+    if (pthread_create(&ids[started], NULL, &trace_record_thread, NULL) != 0) {
+      std::cerr << "could not start thread " << started << ", running with "
+                << started << std::endl;
+      break;
+    }
+  }
+  for (int t = 0; t < started; ++t) {
+    pthread_join(ids[t], NULL);
+  }
+  print_data(s_ring.recorded());
+
+  std::vector<ft::trace_event> events(TRACE_THREADS * TRACE_THREAD_EVENTS);
+  events.resize(s_ring.read(&events[0], events.size()));
+  std::set<unsigned> threads;
+  for (std::size_t i = 0; i < events.size(); ++i) {
+    threads.insert(events[i].thread);
+  }
+  print_data(threads.size());
+  s_ring.clear();
+}
+
+void tests_trace_impl() {
+  print_header("trace impl");
+
+  Chrono chrono("trace impl");
+  chrono.begin();
+
+  trace_ring_impl_test();
+  trace_dump_impl_test();
+  trace_threads_impl_test();
+
+  chrono.stop("total impl");
+  chrono.print();
+}
+
+struct trace_null_case : bench_case {
+  void operator()(std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      ft::null_trace::record(ft::TRACE_NODE_ALLOCATE, i);
+    }
+    clobber_memory();
+  }
+};
+
+struct trace_ring_case : bench_case {
+  ft::trace_ring &ring;
+
+  trace_ring_case(ft::trace_ring &ring) : ring(ring) {}
+
+  void operator()(std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      ring.record(ft::TRACE_NODE_ALLOCATE, i);
+    }
+    clobber_memory();
+  }
+};
+
+#ifndef STD
+/*
+  What a traced build records for a small workload, by event type. Only
+  meaningful when the containers were built with TRACE=1. Reads the ring of
+  the process without clearing it, --trace still dumps the whole run.
+*/
+void trace_workload_perf_test() {
+  std::size_t const n = TRACE_WORKLOAD_SIZE;
+
+  ft::trace_ring const &ring = ft::ring_trace::ring();
+  std::size_t const before = ring.recorded();
+  {
+    ft::vector<int> v;
+    for (std::size_t i = 0; i < n * 10; ++i) {
+      v.push_back(i);
+    }
+    ft::map<int, int> m;
+    for (std::size_t i = 0; i < n; ++i) {
+      m[(i * 7919) % n] = i;
+    }
+    for (std::size_t i = 0; i < n; i += 2) {
+      m.erase(i);
+    }
+  }
+
+  std::size_t const recorded = ring.recorded() - before;
+  // the most recent events are the ones of the workload
+  std::vector<ft::trace_event> events(
+      std::min<std::size_t>(recorded, FT_TRACE_CAPACITY));
+  if (!events.empty()) {
+    ring.read(&events[0], events.size());
+  }
+  std::size_t count[ft::TRACE_EVENT_TYPE_COUNT] = {};
+  std::size_t size[ft::TRACE_EVENT_TYPE_COUNT] = {};
+  for (std::size_t i = 0; i < events.size(); ++i) {
+    ++count[events[i].type];
+    size[events[i].type] += events[i].size;
+  }
+  std::cout << "[TRACE] workload, " << recorded << " events" << std::endl;
+  for (int t = 0; t < ft::TRACE_EVENT_TYPE_COUNT; ++t) {
+    std::cout << "  - " << ft::trace_event_name(ft::trace_event_type(t))
+              << " [" << count[t] << "]: "
+              << (count[t] ? double(size[t]) / count[t] : 0)
+              << " size/event" << std::endl;
+  }
+}
+#endif
+
+void tests_trace_perf() {
+  print_header("trace perf");
+
+  Chrono chrono("trace perf");
+  chrono.begin();
+
+  Bench bench("trace", "event");
+  trace_null_case null_record;
+  bench.run("null record", null_record);
+  trace_ring_case ring_record(s_ring);
+  bench.run("ring record", ring_record);
+  s_ring.clear();
+  bench.print();
+
+#ifndef STD
+  if (ft::trace_policy::enabled) {
+    trace_workload_perf_test();
+  }
+#endif
+
+  chrono.stop("total perf");
+  chrono.print();
+}
@@ -0,0 +1,287 @@
+#include "bench.hpp"
+#include "latency.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <time.h>
+
+double Bench::s_min_time = 0.005;
+std::size_t Bench::s_repetitions = 20;
+bool Bench::s_counters = false;
+std::vector<std::size_t> Bench::s_sweep;
+std::ofstream Bench::s_csv;
+std::ofstream Bench::s_json;
+
+Bench::Bench(std::string const &container, std::string const &type)
+    : m_container(container), m_type(type), m_size(0) {}
+
+Bench::~Bench() {}
+
+void Bench::configure(double min_time, std::size_t repetitions) {
+  s_min_time = min_time;
+  s_repetitions = repetitions > 0 ? repetitions : 1;
+}
+
+char const *Bench::implementation() {
+#ifdef STD
+  return "std";
+#else
+  return "ft";
+#endif
+}
+
+bool Bench::open_csv(std::string const &path) {
+  s_csv.open(path.c_str());
+  if (!s_csv) {
+    return false;
+  }
+  s_csv << "implementation,container,type,operation,size,ns_per_op,min,mean,"
+           "stddev,p99,iterations,repetitions,bytes_per_op,allocs_per_op,"
+           "cycles,instructions,l1d_misses,llc_misses,branch_misses,"
+           "dtlb_misses"
+        << std::endl;
+  return true;
+}
+
+bool Bench::open_json(std::string const &path) {
+  s_json.open(path.c_str());
+  return bool(s_json);
+}
+
+bool Bench::enable_counters() {
+  Counters probe;
+  s_counters = probe.available();
+  return s_counters;
+}
+
+bool Bench::sweep(std::string const &range) {
+  unsigned min;
+  unsigned max;
+  char end;
+  if (std::sscanf(range.c_str(), "%u:%u%c", &min, &max, &end) != 2 ||
+      min > max || max >= sizeof(std::size_t) * 8) {
+    return false;
+  }
+  s_sweep.clear();
+  for (unsigned e = min; e <= max; ++e) {
+    s_sweep.push_back(std::size_t(1) << e);
+  }
+  return true;
+}
+
+std::vector<std::size_t> const &Bench::sweep_sizes() { return s_sweep; }
+
+std::vector<std::size_t> Bench::sweep_sizes_or(unsigned min_log,
+                                               unsigned max_log,
+                                               unsigned step_log) {
+  if (!s_sweep.empty()) {
+    return s_sweep;
+  }
+  std::vector<std::size_t> sizes;
+  for (unsigned e = min_log; e <= max_log; e += step_log ? step_log : 1) {
+    sizes.push_back(std::size_t(1) << e);
+  }
+  return sizes;
+}
+
+void Bench::size(std::size_t n) { m_size = n; }
+
+// nanoseconds
+double Bench::now() {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+// same value when the repetition was long enough
+std::size_t Bench::next_iterations(std::size_t iterations, double elapsed) {
+  double const target = s_min_time * 1e9;
+  if (elapsed >= target || iterations >= (std::size_t(1) << 30)) {
+    return iterations;
+  }
+  double factor = elapsed > 0 ? 1.4 * target / elapsed : 10;
+  factor = std::min(10.0, std::max(2.0, factor));
+  return std::size_t(iterations * factor);
+}
+
+Bench::result Bench::add(std::string const &operation, std::size_t iterations,
+                         std::vector<double> &samples, std::size_t bytes,
+                         std::size_t allocations, Counters const &counters) {
+  std::sort(samples.begin(), samples.end());
+  result r;
+  r.container = m_container;
+  r.type = m_type;
+  r.operation = operation;
+  r.size = m_size;
+  r.iterations = iterations;
+  r.repetitions = samples.size();
+  r.min = samples.front();
+  r.median = samples[samples.size() / 2];
+  double sum = 0;
+  for (std::size_t i = 0; i < samples.size(); ++i) {
+    sum += samples[i];
+  }
+  r.mean = sum / samples.size();
+  double variance = 0;
+  for (std::size_t i = 0; i < samples.size(); ++i) {
+    variance += (samples[i] - r.mean) * (samples[i] - r.mean);
+  }
+  r.stddev = samples.size() > 1 ? std::sqrt(variance / (samples.size() - 1))
+                                 : 0;
+  r.p99 = Latency::percentile(samples, 0.99);
+  double const ops = double(iterations) * samples.size();
+  r.bytes = bytes / ops;
+  r.allocations = allocations / ops;
+  counters.read(r.counters);
+  for (int e = 0; e < Counters::event_count; ++e) {
+    if (r.counters[e] >= 0) {
+      r.counters[e] /= ops;
+    }
+  }
+  m_results.push_back(r);
+  write_csv(r);
+  write_json(r);
+  return r;
+}
+
+// names are plain words, quoting is enough
+void Bench::write_csv(result const &r) {
+  if (!s_csv.is_open()) {
+    return;
+  }
+  s_csv << implementation() << ",\"" << r.container << "\",\"" << r.type
+        << "\",\"" << r.operation << "\"," << r.size << "," << r.median << ","
+        << r.min << "," << r.mean << "," << r.stddev << "," << r.p99 << ","
+        << r.iterations << "," << r.repetitions << "," << r.bytes << ","
+        << r.allocations;
+  for (int e = 0; e < Counters::event_count; ++e) {
+    s_csv << ",";
+    if (r.counters[e] >= 0) {
+      s_csv << r.counters[e];
+    }
+  }
+  s_csv << std::endl;
+}
+
+void Bench::write_json(result const &r) {
+  if (!s_json.is_open()) {
+    return;
+  }
+  s_json << "{\"implementation\": \"" << implementation()
+         << "\", \"container\": \"" << r.container << "\", \"type\": \""
+         << r.type << "\", \"operation\": \"" << r.operation
+         << "\", \"size\": " << r.size << ", \"ns_per_op\": " << r.median
+         << ", \"min\": " << r.min << ", \"mean\": " << r.mean
+         << ", \"stddev\": " << r.stddev << ", \"p99\": " << r.p99
+         << ", \"iterations\": " << r.iterations
+         << ", \"repetitions\": " << r.repetitions
+         << ", \"bytes_per_op\": " << r.bytes
+         << ", \"allocs_per_op\": " << r.allocations;
+  static char const *const keys[Counters::event_count] = {
+      "cycles",     "instructions",  "l1d_misses",
+      "llc_misses", "branch_misses", "dtlb_misses"};
+  for (int e = 0; e < Counters::event_count; ++e) {
+    s_json << ", \"" << keys[e] << "\": ";
+    if (r.counters[e] >= 0) {
+      s_json << r.counters[e];
+    } else {
+      s_json << "null";
+    }
+  }
+  s_json << "}" << std::endl;
+}
+
+std::vector<Bench::result> const &Bench::results() const {
+  return m_results;
+}
+
+// one line per result, only when counters were enabled
+void Bench::print_counters(result const &r) {
+  if (!s_counters) {
+    return;
+  }
+  std::cout << "    ";
+  for (int e = 0; e < Counters::event_count; ++e) {
+    std::cout << (e ? ", " : "") << Counters::name(Counters::event(e)) << " ";
+    if (r.counters[e] < 0) {
+      std::cout << "n/a";
+    } else {
+      std::cout << r.counters[e];
+    }
+    if (e == Counters::instructions && r.counters[Counters::cycles] > 0 &&
+        r.counters[e] >= 0) {
+      std::cout << " (IPC " << r.counters[e] / r.counters[Counters::cycles]
+                << ")";
+    }
+  }
+  std::cout << " per op" << std::endl;
+}
+
+void Bench::print() const {
+  std::cout << "[BENCH] " << m_container << " " << m_type << " ("
+            << implementation() << ")" << std::endl;
+  for (std::vector<result>::const_iterator it = m_results.begin();
+       it != m_results.end(); ++it) {
+    std::cout << "  - " << it->operation;
+    if (it->size) {
+      std::cout << " [" << it->size << "]";
+    }
+    std::cout << ": " << it->median << " ns/op (min " << it->min << ", mean "
+              << it->mean << ", stddev " << it->stddev << ", p99 " << it->p99
+              << ", " << it->iterations << "x" << it->repetitions << ", "
+              << it->bytes << " B/op, " << it->allocations << " allocs/op)"
+              << std::endl;
+    print_counters(*it);
+  }
+}
+
+// the last column is not padded
+static int column_width(std::vector<std::string> const &operations,
+                        std::size_t o) {
+  if (o + 1 == operations.size()) {
+    return 0;
+  }
+  return std::max<int>(operations[o].size(), 10) + 2;
+}
+
+void Bench::print_curves() const {
+  std::vector<std::string> operations;
+  std::vector<std::size_t> sizes;
+  for (std::vector<result>::const_iterator it = m_results.begin();
+       it != m_results.end(); ++it) {
+    if (std::find(operations.begin(), operations.end(), it->operation) ==
+        operations.end()) {
+      operations.push_back(it->operation);
+    }
+    if (std::find(sizes.begin(), sizes.end(), it->size) == sizes.end()) {
+      sizes.push_back(it->size);
+    }
+  }
+  std::cout << "[CURVES] " << m_container << " " << m_type << " ("
+            << implementation() << ") ns/op" << std::endl;
+  std::cout << "  " << std::left << std::setw(12) << "size";
+  for (std::size_t o = 0; o < operations.size(); ++o) {
+    std::cout << std::setw(column_width(operations, o)) << operations[o];
+  }
+  std::cout << std::endl;
+  for (std::size_t s = 0; s < sizes.size(); ++s) {
+    std::cout << "  " << std::setw(12) << sizes[s];
+    for (std::size_t o = 0; o < operations.size(); ++o) {
+      std::vector<result>::const_iterator it = m_results.begin();
+      while (it != m_results.end() &&
+             (it->size != sizes[s] || it->operation != operations[o])) {
+        ++it;
+      }
+      std::cout << std::setw(column_width(operations, o));
+      if (it == m_results.end()) {
+        std::cout << "-";
+      } else {
+        std::cout << it->median;
+      }
+    }
+    std::cout << std::endl;
+  }
+  std::cout << std::right;
+}
@@ -0,0 +1,159 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include "counters.hpp"
+#include "memory.hpp"
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// keeps the computation of value from being optimized away
+template <typename T> inline void do_not_optimize(T const &value) {
+  __asm__ __volatile__("" : : "r,m"(value) : "memory");
+}
+
+// forces pending writes to memory to be considered observable
+inline void clobber_memory() { __asm__ __volatile__("" : : : "memory"); }
+
+/*
+  Base of the benchmark cases. A case is a functor whose operator()(n) runs
+  the measured operation n times; setup(n) is called before every repetition
+  and is not timed, cases that consume their input refill it there.
+*/
+struct bench_case {
+  void setup(std::size_t) {}
+};
+
+/*
+  Runs every case for a calibrated number of iterations, so one repetition
+  lasts long enough for the clock to be meaningful, then repeats it and
+  reports the distribution of the time per operation. Case names are the same
+  in the ft and std builds so their results can be paired.
+
+  Besides the text report every result can be written as a CSV row and as a
+  JSON object per line, see open_csv and open_json. Only Bench results are
+  written there, Chrono and Latency print to the text report alone. With
+  enable_counters the hardware counters of the timed repetitions are
+  reported too.
+*/
+class Bench {
+public:
+  struct result {
+    std::string container;
+    std::string type;
+    std::string operation;
+    std::size_t size; // elements in the container
+    std::size_t iterations; // per repetition
+    std::size_t repetitions;
+    // nanoseconds per operation
+    double min;
+    double median;
+    double mean;
+    double stddev;
+    double p99;
+    // heap traffic per operation, from the global operator new
+    double bytes;
+    double allocations;
+    // hardware events per operation, negative when unavailable
+    double counters[Counters::event_count];
+  };
+
+private:
+  std::string m_container;
+  std::string m_type;
+  std::size_t m_size;
+  std::vector<result> m_results;
+
+  static double s_min_time;
+  static std::size_t s_repetitions;
+  static bool s_counters;
+  static std::vector<std::size_t> s_sweep;
+  static std::ofstream s_csv;
+  static std::ofstream s_json;
+
+  static std::size_t next_iterations(std::size_t iterations, double elapsed);
+  static void write_csv(result const &r);
+  static void write_json(result const &r);
+  static void print_counters(result const &r);
+  result add(std::string const &operation, std::size_t iterations,
+             std::vector<double> &samples, std::size_t bytes,
+             std::size_t allocations, Counters const &counters);
+
+public:
+  Bench(std::string const &container, std::string const &type);
+
+  ~Bench();
+
+  // seconds per repetition to aim for and number of repetitions
+  static void configure(double min_time, std::size_t repetitions);
+  static char const *implementation();
+  // monotonic clock, in nanoseconds
+  static double now();
+  static bool open_csv(std::string const &path);
+  static bool open_json(std::string const &path);
+  // false when no counter can be opened, they stay disabled then
+  static bool enable_counters();
+  /*
+    Sizes of a scaling run, every power of two from 2^min to 2^max given as
+    "min:max". false when the range cannot be parsed.
+  */
+  static bool sweep(std::string const &range);
+  // empty unless a sweep was asked for
+  static std::vector<std::size_t> const &sweep_sizes();
+  // the sweep sizes, else every step_log power of two from 2^min to 2^max
+  static std::vector<std::size_t> sweep_sizes_or(unsigned min_log,
+                                                 unsigned max_log,
+                                                 unsigned step_log = 1);
+
+  // size of the data set the following cases work on
+  void size(std::size_t n);
+
+  template <typename F> result run(std::string const &operation, F &f) {
+    std::size_t iterations = 1;
+    for (;;) {
+      f.setup(iterations);
+      double const start = now();
+      f(iterations);
+      double const elapsed = now() - start;
+      std::size_t const next = next_iterations(iterations, elapsed);
+      if (next == iterations) {
+        break;
+      }
+      iterations = next;
+    }
+    return run(operation, f, iterations);
+  }
+
+  // without calibration, for cases limited by the size of their input
+  template <typename F>
+  result run(std::string const &operation, F &f, std::size_t iterations) {
+    std::vector<double> samples;
+    samples.reserve(s_repetitions);
+    Counters counters(s_counters);
+    std::size_t bytes = 0;
+    std::size_t allocations = 0;
+    for (std::size_t r = 0; r < s_repetitions; ++r) {
+      f.setup(iterations);
+      std::size_t const bytes_before = allocated_bytes();
+      std::size_t const allocations_before = allocation_calls();
+      counters.start();
+      double const start = now();
+      f(iterations);
+      double const elapsed = now() - start;
+      counters.stop();
+      bytes += allocated_bytes() - bytes_before;
+      allocations += allocation_calls() - allocations_before;
+      samples.push_back(elapsed / iterations);
+    }
+    return add(operation, iterations, samples, bytes, allocations, counters);
+  }
+
+  std::vector<result> const &results() const;
+  void print() const;
+  // median ns/op of every operation by size, one row per size
+  void print_curves() const;
+};
+
+#endif
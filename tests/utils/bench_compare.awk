@@ -0,0 +1,54 @@
+# Pairs the cases of two Bench CSV reports, the std one first then the ft
+# one, and prints the ft/std ratio of the median ns/op. Exits with 1 when a
+# ratio is above threshold (default 1.25). base and candidate rename the
+# columns when comparing other builds.
+#
+#   awk -F, -v threshold=1.1 -f bench_compare.awk std.csv ft.csv
+
+BEGIN {
+  if (threshold == "") {
+    threshold = 1.25
+  }
+  if (base == "") {
+    base = "std"
+  }
+  if (candidate == "") {
+    candidate = "ft"
+  }
+  format = "%-10s %-22s %-42s %9s %12s %12s %7s %10s %10s  %s\n"
+  printf format, "container", "type", "operation", "size", \
+         candidate " ns/op", base " ns/op", "ratio", candidate " B/op", \
+         base " B/op", ""
+}
+
+FNR == 1 { next }
+
+{
+  gsub(/"/, "")
+  key = $2 SUBSEP $3 SUBSEP $4 SUBSEP $5
+}
+
+NR == FNR {
+  std_ns[key] = $6
+  std_bytes[key] = $13
+  next
+}
+
+key in std_ns {
+  ratio = std_ns[key] > 0 ? $6 / std_ns[key] : 0
+  status = ""
+  if (ratio > threshold) {
+    status = "REGRESSION"
+    ++regressions
+  }
+  ++cases
+  printf format, $2, $3, $4, $5, sprintf("%.2f", $6), \
+         sprintf("%.2f", std_ns[key]), sprintf("%.2f", ratio), \
+         sprintf("%.1f", $13), sprintf("%.1f", std_bytes[key]), status
+}
+
+END {
+  printf "\n%d cases, %d above the %.2f threshold\n", cases, regressions, \
+         threshold
+  exit regressions > 0
+}
@@ -1,4 +1,5 @@
 #include "chrono.hpp"
+#include "memory.hpp"
 #include <iostream>
 
 Chrono::Chrono(std::string const &name) : m_name(name) {}
@@ -10,17 +11,22 @@ void Chrono::reset() { m_records.clear(); }
 void Chrono::begin() {
   if (m_records.empty()) {
     rec r;
-    clock_gettime(CLOCK_MONOTONIC, &r.time);
+    r.rss = get_rss();
     std::ios_base::sync_with_stdio(false);
+    clock_gettime(CLOCK_MONOTONIC, &r.time);
+    r.resume = r.time;
     m_records.push_back(r);
   }
 }
 
 void Chrono::stop(std::string const &name) {
   rec r;
-  r.name = name;
   clock_gettime(CLOCK_MONOTONIC, &r.time);
+  r.name = name;
+  r.rss = get_rss();
   m_records.push_back(r);
+  // the bookkeeping above is not accounted to the next record
+  clock_gettime(CLOCK_MONOTONIC, &m_records.back().resume);
 }
 
 void Chrono::print() const {
@@ -30,7 +36,11 @@ void Chrono::print() const {
     for (std::vector<rec>::const_iterator it = m_records.begin() + 1;
          it != m_records.end(); ++it) {
       std::cout << "  - " << it->name << ": "
-                << get_time_diff((it - 1)->time, it->time) << std::endl;
+                << get_time_diff((it - 1)->resume, it->time);
+      if (it->rss >= 0) {
+        std::cout << " (rss: " << it->rss << " KiB)";
+      }
+      std::cout << std::endl;
     }
   } else {
     std::cout << m_name << ": does not have enough records" << std::endl;
@@ -43,4 +53,10 @@ double Chrono::get_time_diff(struct timespec const &first,
   time_taken = (second.tv_sec - first.tv_sec) * 1e9;
   time_taken = (time_taken + (second.tv_nsec - first.tv_nsec)) * 1e-9;
   return time_taken;
-}
\ No newline at end of file
+}
+
+// resident set size in KiB, -1 when /proc is not available
+long Chrono::get_rss() {
+  long const bytes = resident_bytes();
+  return bytes < 0 ? -1 : bytes / 1024;
+}
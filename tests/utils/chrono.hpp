@@ -9,6 +9,8 @@ class Chrono {
   std::string m_name;
   struct rec {
     struct timespec time;
+    struct timespec resume;
+    long rss;
     std::string name;
   };
   std::vector<rec> m_records;
@@ -18,6 +20,8 @@ class Chrono {
   static double get_time_diff(struct timespec const &first,
                               struct timespec const &second);
 
+  static long get_rss();
+
 public:
   Chrono(std::string const &name);
 
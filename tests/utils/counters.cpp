@@ -0,0 +1,118 @@
+#include "counters.hpp"
+
+#ifdef __linux__
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+static int open_event(unsigned type, unsigned long long config) {
+  struct perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format =
+      PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  return syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static unsigned long long cache_event(unsigned cache) {
+  return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+         (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+#endif
+
+Counters::Counters(bool enable) {
+  for (int e = 0; e < event_count; ++e) {
+    m_fds[e] = -1;
+  }
+#ifdef __linux__
+  if (!enable) {
+    return;
+  }
+  m_fds[cycles] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+  m_fds[instructions] =
+      open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+  m_fds[l1d_misses] =
+      open_event(PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_L1D));
+  m_fds[llc_misses] =
+      open_event(PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_LL));
+  m_fds[branch_misses] =
+      open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+  m_fds[dtlb_misses] =
+      open_event(PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_DTLB));
+#else
+  (void)enable;
+#endif
+}
+
+Counters::~Counters() {
+#ifdef __linux__
+  for (int e = 0; e < event_count; ++e) {
+    if (m_fds[e] >= 0) {
+      close(m_fds[e]);
+    }
+  }
+#endif
+}
+
+char const *Counters::name(event e) {
+  static char const *const names[event_count] = {
+      "cycles",        "instructions", "L1d misses", "LLC misses",
+      "branch misses", "dTLB misses"};
+  return names[e];
+}
+
+bool Counters::available() const {
+  for (int e = 0; e < event_count; ++e) {
+    if (m_fds[e] >= 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void Counters::start() {
+#ifdef __linux__
+  for (int e = 0; e < event_count; ++e) {
+    if (m_fds[e] >= 0) {
+      ioctl(m_fds[e], PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+#endif
+}
+
+void Counters::stop() {
+#ifdef __linux__
+  for (int e = 0; e < event_count; ++e) {
+    if (m_fds[e] >= 0) {
+      ioctl(m_fds[e], PERF_EVENT_IOC_DISABLE, 0);
+    }
+  }
+#endif
+}
+
+void Counters::read(double (&values)[event_count]) const {
+  for (int e = 0; e < event_count; ++e) {
+    values[e] = -1;
+#ifdef __linux__
+    // value, time enabled, time running
+    unsigned long long data[3];
+    if (m_fds[e] < 0 || ::read(m_fds[e], data, sizeof(data)) != sizeof(data)) {
+      continue;
+    }
+    if (data[2] > 0) {
+      values[e] = double(data[0]) * data[1] / data[2];
+    } else if (data[1] == 0) {
+      values[e] = 0;
+    }
+#endif
+  }
+}
@@ -0,0 +1,47 @@
+#ifndef COUNTERS_HPP
+#define COUNTERS_HPP
+
+/*
+  Hardware counters of the calling thread through perf_event_open (Linux).
+  Every event is opened on its own, an event the CPU, the kernel or
+  perf_event_paranoid does not allow is reported as unavailable and the
+  others still count. Counts are scaled when the kernel multiplexes them.
+
+  The counters are opened disabled and accumulate over every start/stop
+  interval.
+*/
+class Counters {
+public:
+  enum event {
+    cycles,
+    instructions,
+    l1d_misses,
+    llc_misses,
+    branch_misses,
+    dtlb_misses,
+    event_count
+  };
+
+private:
+  int m_fds[event_count];
+
+  Counters(Counters const &);
+  Counters &operator=(Counters const &);
+
+public:
+  // nothing is opened when enable is false, every event is unavailable
+  explicit Counters(bool enable = true);
+
+  ~Counters();
+
+  static char const *name(event e);
+
+  // at least one event counts
+  bool available() const;
+  void start();
+  void stop();
+  // counts so far, negative for the unavailable events
+  void read(double (&values)[event_count]) const;
+};
+
+#endif
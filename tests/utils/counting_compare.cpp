@@ -0,0 +1,32 @@
+#include "counting_compare.hpp"
+
+#include <iostream>
+
+std::size_t &comparison_counter() {
+  static std::size_t count = 0;
+  return count;
+}
+
+Comparisons::Comparisons(std::string const &name, std::size_t *count)
+    : m_name(name), m_count(count), m_start(*count) {}
+
+void Comparisons::begin() { m_start = *m_count; }
+
+void Comparisons::stop(std::string const &name, std::size_t ops) {
+  rec r;
+  r.name = name;
+  r.ops = ops ? ops : 1;
+  r.comparisons = *m_count - m_start;
+  m_records.push_back(r);
+  begin();
+}
+
+void Comparisons::print() const {
+  std::cout << "[COMPARISONS] " << m_name << std::endl;
+  for (std::vector<rec>::const_iterator it = m_records.begin();
+       it != m_records.end(); ++it) {
+    std::cout << "  - " << it->name << " [" << it->ops
+              << "]: " << double(it->comparisons) / it->ops << " cmp/op"
+              << std::endl;
+  }
+}
@@ -0,0 +1,59 @@
+#ifndef COUNTING_COMPARE_HPP
+#define COUNTING_COMPARE_HPP
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+// the counter of every counting_compare that was not given its own
+std::size_t &comparison_counter();
+
+/*
+  Compare with a call counter, for the compare parameter of any ft or std
+  ordered container. Copies, like the one a container keeps, share the
+  counter they were built with. Not thread safe, one counter per thread.
+*/
+template <typename T, typename Compare = std::less<T> >
+class counting_compare {
+  std::size_t *m_count;
+  Compare m_compare;
+
+public:
+  explicit counting_compare(std::size_t *count = &comparison_counter(),
+                            Compare const &compare = Compare())
+      : m_count(count), m_compare(compare) {}
+
+  std::size_t *count() const { return m_count; }
+
+  bool operator()(T const &lhs, T const &rhs) const {
+    ++*m_count;
+    return m_compare(lhs, rhs);
+  }
+};
+
+/*
+  Same usage as Allocations, every stop reports the comparisons made since
+  the previous one, divided by the number of operations.
+*/
+class Comparisons {
+  struct rec {
+    std::string name;
+    std::size_t ops;
+    std::size_t comparisons;
+  };
+  std::string m_name;
+  std::size_t *m_count;
+  std::size_t m_start;
+  std::vector<rec> m_records;
+
+public:
+  Comparisons(std::string const &name,
+              std::size_t *count = &comparison_counter());
+
+  void begin();
+  void stop(std::string const &name, std::size_t ops);
+  void print() const;
+};
+
+#endif
@@ -0,0 +1,55 @@
+#include "latency.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+Latency::Latency(std::string const &name, std::size_t expected_samples)
+    : m_name(name) {
+  m_samples.reserve(expected_samples);
+}
+
+Latency::~Latency() {}
+
+void Latency::reset() { m_samples.clear(); }
+
+void Latency::begin() { clock_gettime(CLOCK_MONOTONIC, &m_start); }
+
+// sample in nanoseconds
+void Latency::stop() {
+  struct timespec end;
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  record((end.tv_sec - m_start.tv_sec) * 1e9 + (end.tv_nsec - m_start.tv_nsec));
+}
+
+// for durations measured elsewhere, e.g. across threads
+void Latency::record(double ns) { m_samples.push_back(ns); }
+
+void Latency::print() const {
+  std::cout << "[LATENCY] ";
+  if (m_samples.empty()) {
+    std::cout << m_name << ": does not have enough samples" << std::endl;
+    return;
+  }
+  std::vector<double> sorted(m_samples);
+  std::sort(sorted.begin(), sorted.end());
+  std::cout << m_name << " (ns)" << std::endl;
+  std::cout << "  - p50: " << percentile(sorted, 0.50) << std::endl;
+  std::cout << "  - p99: " << percentile(sorted, 0.99) << std::endl;
+  std::cout << "  - p99.9: " << percentile(sorted, 0.999) << std::endl;
+  std::cout << "  - max: " << sorted.back() << std::endl;
+}
+
+// nearest rank: the smallest sample with at least p of the samples at or below
+double Latency::percentile(std::vector<double> const &sorted, double p) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  double const rank = std::ceil(p * sorted.size());
+  if (rank <= 1) {
+    return sorted.front();
+  }
+  if (rank >= sorted.size()) {
+    return sorted.back();
+  }
+  return sorted[static_cast<std::size_t>(rank) - 1];
+}
@@ -0,0 +1,33 @@
+#ifndef LATENCY_HPP
+#define LATENCY_HPP
+
+#include <cstddef>
+#include <string>
+#include <sys/time.h>
+#include <vector>
+
+/*
+  Records the duration of single operations and reports their distribution,
+  a mean alone hides the occasional slow operation (block or map allocation).
+*/
+class Latency {
+  std::string m_name;
+  struct timespec m_start;
+  std::vector<double> m_samples;
+
+public:
+  // nearest rank in sorted samples, 0 when there are none
+  static double percentile(std::vector<double> const &sorted, double p);
+
+  Latency(std::string const &name, std::size_t expected_samples = 0);
+
+  ~Latency();
+
+  void reset();
+  void begin();
+  void stop();
+  void record(double ns);
+  void print() const;
+};
+
+#endif
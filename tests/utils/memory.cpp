@@ -0,0 +1,64 @@
+#include "memory.hpp"
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <unistd.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+static std::size_t g_allocated_bytes = 0;
+static std::size_t g_allocation_calls = 0;
+static bool g_count_allocations = true;
+
+std::size_t allocated_bytes() {
+  return __atomic_load_n(&g_allocated_bytes, __ATOMIC_RELAXED);
+}
+
+std::size_t allocation_calls() {
+  return __atomic_load_n(&g_allocation_calls, __ATOMIC_RELAXED);
+}
+
+bool count_allocations(bool enabled) {
+  return __atomic_exchange_n(&g_count_allocations, enabled, __ATOMIC_RELAXED);
+}
+
+long resident_bytes() {
+  std::ifstream statm("/proc/self/statm");
+  long size;
+  long resident;
+  if (!(statm >> size >> resident)) {
+    return -1;
+  }
+  return resident * sysconf(_SC_PAGESIZE);
+}
+
+void release_free_memory() {
+#ifdef __GLIBC__
+  malloc_trim(0);
+#endif
+}
+
+static void *counted_malloc(std::size_t size) {
+  if (__atomic_load_n(&g_count_allocations, __ATOMIC_RELAXED)) {
+    __atomic_add_fetch(&g_allocated_bytes, size, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&g_allocation_calls, 1, __ATOMIC_RELAXED);
+  }
+  void *p = std::malloc(size ? size : 1);
+  if (p == NULL) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void *operator new(std::size_t size) throw(std::bad_alloc) {
+  return counted_malloc(size);
+}
+
+void *operator new[](std::size_t size) throw(std::bad_alloc) {
+  return counted_malloc(size);
+}
+
+void operator delete(void *p) throw() { std::free(p); }
+
+void operator delete[](void *p) throw() { std::free(p); }
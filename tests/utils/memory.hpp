@@ -0,0 +1,25 @@
+#ifndef MEMORY_HPP
+#define MEMORY_HPP
+
+#include <cstddef>
+
+/*
+  Totals of the global operator new since the start of the program, counted
+  by the replacement operators in memory.cpp. Both builds go through them,
+  whatever allocator the containers use in the end calls operator new.
+*/
+std::size_t allocated_bytes();
+std::size_t allocation_calls();
+/*
+  Counting is on by default. Off, operator new leaves the shared totals
+  alone, threads allocating at once would otherwise contend on them. Returns
+  the previous state.
+*/
+bool count_allocations(bool enabled);
+
+// resident set size from /proc/self/statm, -1 when it is not available
+long resident_bytes();
+// gives the free heap pages back to the system, so RSS deltas are meaningful
+void release_free_memory();
+
+#endif
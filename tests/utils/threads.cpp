@@ -0,0 +1,66 @@
+#include "threads.hpp"
+#include "latency.hpp"
+#include <algorithm>
+
+Threads::Threads(std::string const &container, std::string const &type)
+    : m_container(container), m_type(type) {}
+
+Threads::~Threads() {}
+
+// round robin over the CPUs the process may run on
+int Threads::pin(std::size_t index) {
+#ifdef __linux__
+  cpu_set_t allowed;
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+    return -1;
+  }
+  int const count = CPU_COUNT(&allowed);
+  if (count == 0) {
+    return -1;
+  }
+  int nth = int(index % count);
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (CPU_ISSET(cpu, &allowed) && nth-- == 0) {
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      CPU_SET(cpu, &set);
+      if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+        return -1;
+      }
+      return cpu;
+    }
+  }
+#else
+  (void)index;
+#endif
+  return -1;
+}
+
+void Threads::add(result &r) {
+  for (std::size_t t = 0; t < r.samples.size(); ++t) {
+    std::sort(r.samples[t].begin(), r.samples[t].end());
+  }
+  m_results.push_back(r);
+}
+
+void Threads::print() const {
+  std::cout << "[THREADS] " << m_container << " " << m_type << " ("
+            << Bench::implementation() << ")" << std::endl;
+  for (std::vector<result>::const_iterator it = m_results.begin();
+       it != m_results.end(); ++it) {
+    std::size_t const threads = it->samples.size();
+    double const total = double(it->ops) * threads / it->seconds;
+    std::cout << "  - " << it->operation << " [" << threads
+              << " threads]: " << total / 1e6 << " Mops/s ("
+              << total / 1e6 / threads << " per thread)" << std::endl;
+    for (std::size_t t = 0; t < threads; ++t) {
+      std::vector<double> const &s = it->samples[t];
+      std::cout << "    thread " << t << " cpu " << it->cpus[t]
+                << ": p50 " << Latency::percentile(s, 0.50) << ", p99 "
+                << Latency::percentile(s, 0.99) << ", p99.9 "
+                << Latency::percentile(s, 0.999)
+                << ", max " << (s.empty() ? 0 : s.back()) << " ns/op"
+                << std::endl;
+    }
+  }
+}
@@ -0,0 +1,132 @@
+#ifndef THREADS_HPP
+#define THREADS_HPP
+
+#include "bench.hpp"
+#include "memory.hpp"
+
+#include <cstddef>
+#include <iostream>
+#include <pthread.h>
+#include <sched.h>
+#include <string>
+#include <vector>
+
+/*
+  Runs one bench case per thread, all threads started at once, each pinned
+  to its own CPU while there are enough of them. Whether the cases share a
+  container or own one is up to the caller. Reports the aggregate
+  throughput and, per thread, the distribution of the time per operation
+  over batches of operations, a clock read per operation would cost more
+  than the lookups it measures.
+*/
+class Threads {
+  struct result {
+    std::string operation;
+    std::size_t ops; // per thread
+    double seconds;
+    std::vector<int> cpus;
+    std::vector<std::vector<double> > samples; // sorted, ns per operation
+  };
+
+  template <typename F> struct worker {
+    F *f;
+    std::size_t index;
+    std::size_t ops;
+    std::size_t batch;
+    int *ready;
+    int const *start;
+    int cpu;
+    std::vector<double> samples;
+
+    static void *run(void *arg) {
+      worker *w = static_cast<worker *>(arg);
+      w->cpu = Threads::pin(w->index);
+      w->f->setup(w->ops);
+      w->samples.reserve(w->ops / w->batch + 1);
+      __atomic_add_fetch(w->ready, 1, __ATOMIC_RELEASE);
+      while (!__atomic_load_n(w->start, __ATOMIC_ACQUIRE)) {
+        sched_yield();
+      }
+      for (std::size_t done = 0; done < w->ops;) {
+        std::size_t const n =
+            w->batch < w->ops - done ? w->batch : w->ops - done;
+        double const begin = Bench::now();
+        (*w->f)(n);
+        w->samples.push_back((Bench::now() - begin) / n);
+        done += n;
+      }
+      return NULL;
+    }
+  };
+
+  std::string m_container;
+  std::string m_type;
+  std::vector<result> m_results;
+
+  // CPU the calling thread was pinned to, -1 when it could not be
+  static int pin(std::size_t index);
+  void add(result &r);
+
+public:
+  Threads(std::string const &container, std::string const &type);
+
+  ~Threads();
+
+  /*
+    One thread per case, each running ops operations in batches. When a
+    thread cannot be created the run goes on with the ones already started,
+    the report shows how many there were.
+  */
+  template <typename F>
+  void run(std::string const &operation, std::vector<F *> const &cases,
+           std::size_t ops, std::size_t batch = 64) {
+    std::size_t n = cases.size();
+    std::vector<worker<F> > workers(n);
+    std::vector<pthread_t> ids(n);
+    int ready = 0;
+    int start = 0;
+    // the shared allocation totals would be what the threads contend on
+    bool const counting = count_allocations(false);
+    for (std::size_t t = 0; t < n; ++t) {
+      worker<F> &w = workers[t];
+      w.f = cases[t];
+      w.index = t;
+      w.ops = ops;
+      w.batch = batch ? batch : 1;
+      w.ready = &ready;
+      w.start = &start;
+      if (pthread_create(&ids[t], NULL, &worker<F>::run, &w) != 0) {
+        std::cerr << "[THREADS] " << operation << ": could not start thread "
+                  << t << ", running with " << t << std::endl;
+        n = t;
+        break;
+      }
+    }
+    if (n == 0) {
+      count_allocations(counting);
+      return;
+    }
+    while (__atomic_load_n(&ready, __ATOMIC_ACQUIRE) != int(n)) {
+      sched_yield();
+    }
+    double const begin = Bench::now();
+    __atomic_store_n(&start, 1, __ATOMIC_RELEASE);
+    for (std::size_t t = 0; t < n; ++t) {
+      pthread_join(ids[t], NULL);
+    }
+    count_allocations(counting);
+    result r;
+    r.operation = operation;
+    r.ops = ops;
+    r.seconds = (Bench::now() - begin) * 1e-9;
+    for (std::size_t t = 0; t < n; ++t) {
+      r.cpus.push_back(workers[t].cpu);
+      r.samples.push_back(workers[t].samples);
+    }
+    add(r);
+  }
+
+  void print() const;
+};
+
+#endif
@@ -0,0 +1,150 @@
+#include "tracking_allocator.hpp"
+#include "memory.hpp"
+#include <algorithm>
+#include <iostream>
+
+/* ---------------------------- allocation_stats ---------------------------- */
+allocation_stats::allocation_stats() : m_live(0) { reset(); }
+
+allocation_stats &allocation_stats::global() {
+  static allocation_stats stats;
+  return stats;
+}
+
+std::size_t allocation_stats::bucket(std::size_t bytes) {
+  std::size_t b = 0;
+  for (; bytes != 0 && b + 1 < buckets; bytes >>= 1) {
+    ++b;
+  }
+  return b;
+}
+
+void allocation_stats::reset() {
+  m_allocations = 0;
+  m_deallocations = 0;
+  m_bytes = 0;
+  m_peak = m_live;
+  std::fill(m_histogram, m_histogram + buckets, 0);
+}
+
+void allocation_stats::allocate(std::size_t bytes) {
+  ++m_allocations;
+  m_bytes += bytes;
+  m_live += bytes;
+  m_peak = std::max(m_peak, m_live);
+  ++m_histogram[bucket(bytes)];
+}
+
+void allocation_stats::deallocate(std::size_t bytes) {
+  ++m_deallocations;
+  m_live -= bytes;
+}
+
+std::size_t allocation_stats::allocations() const { return m_allocations; }
+
+std::size_t allocation_stats::deallocations() const {
+  return m_deallocations;
+}
+
+std::size_t allocation_stats::bytes() const { return m_bytes; }
+
+std::size_t allocation_stats::live() const { return m_live; }
+
+std::size_t allocation_stats::peak() const { return m_peak; }
+
+std::size_t allocation_stats::histogram(std::size_t bucket) const {
+  return m_histogram[bucket];
+}
+
+/* ------------------------------- Allocations ------------------------------ */
+Allocations::Allocations(std::string const &name, allocation_stats *stats)
+    : m_name(name), m_stats(stats), m_live_start(0), m_resident_start(-1) {
+  std::fill(m_histogram, m_histogram + allocation_stats::buckets, 0);
+}
+
+Allocations::~Allocations() {}
+
+void Allocations::begin() {
+  if (m_records.empty() && m_footprints.empty()) {
+    release_free_memory();
+    m_live_start = m_stats->live();
+    m_resident_start = resident_bytes();
+  }
+  m_stats->reset();
+  clock_gettime(CLOCK_MONOTONIC, &m_start);
+}
+
+void Allocations::stop(std::string const &name, std::size_t ops) {
+  struct timespec end;
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  rec r;
+  r.name = name;
+  r.ops = ops ? ops : 1;
+  r.time =
+      (end.tv_sec - m_start.tv_sec) * 1e9 + (end.tv_nsec - m_start.tv_nsec);
+  r.allocations = m_stats->allocations();
+  r.deallocations = m_stats->deallocations();
+  r.bytes = m_stats->bytes();
+  r.peak = m_stats->peak();
+  m_records.push_back(r);
+  for (std::size_t b = 0; b < allocation_stats::buckets; ++b) {
+    m_histogram[b] += m_stats->histogram(b);
+  }
+  // the bookkeeping above is not accounted to the next record
+  begin();
+}
+
+void Allocations::footprint(std::string const &name, std::size_t elements,
+                            std::size_t payload) {
+  footprint_rec r;
+  r.name = name;
+  r.elements = elements ? elements : 1;
+  r.payload = payload;
+  r.live = m_stats->live() - m_live_start;
+  // what was freed on the way, as old vector buffers, is not held
+  release_free_memory();
+  long const resident = resident_bytes();
+  r.resident = resident < 0 || m_resident_start < 0
+                   ? -1
+                   : resident - m_resident_start;
+  m_footprints.push_back(r);
+  // not accounted to the next record
+  clock_gettime(CLOCK_MONOTONIC, &m_start);
+}
+
+void Allocations::print() const {
+  std::cout << "[ALLOCATIONS] " << m_name << std::endl;
+  for (std::vector<rec>::const_iterator it = m_records.begin();
+       it != m_records.end(); ++it) {
+    std::cout << "  - " << it->name << " [" << it->ops
+              << "]: " << it->time / it->ops << " ns/op, "
+              << double(it->allocations) / it->ops << " allocs/op, "
+              << double(it->deallocations) / it->ops << " frees/op, "
+              << double(it->bytes) / it->ops << " B/op, peak " << it->peak
+              << " B" << std::endl;
+  }
+  for (std::vector<footprint_rec>::const_iterator it = m_footprints.begin();
+       it != m_footprints.end(); ++it) {
+    double const allocated = double(it->live) / it->elements;
+    std::cout << "  - footprint " << it->name << " [" << it->elements
+              << " x " << it->payload << " B]: " << allocated
+              << " B/elem allocated (" << allocated - it->payload
+              << " overhead)";
+    if (it->resident >= 0) {
+      double const resident = double(it->resident) / it->elements;
+      // malloc headers add to it, capacity never touched is not resident
+      std::cout << ", " << resident << " B/elem resident ("
+                << resident - allocated << " vs allocated)";
+    }
+    std::cout << std::endl;
+  }
+  std::cout << "  sizes:";
+  for (std::size_t b = 0; b < allocation_stats::buckets; ++b) {
+    if (m_histogram[b] != 0) {
+      std::size_t const low = b ? std::size_t(1) << (b - 1) : 0;
+      std::cout << " [" << low << ", " << (std::size_t(1) << b)
+                << ") x" << m_histogram[b];
+    }
+  }
+  std::cout << std::endl;
+}
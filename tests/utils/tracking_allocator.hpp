@@ -0,0 +1,166 @@
+#ifndef TRACKING_ALLOCATOR_HPP
+#define TRACKING_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <new>
+#include <string>
+#include <sys/time.h>
+#include <vector>
+
+/*
+  Heap traffic seen by the tracking allocators pointing to it: calls, bytes,
+  live and peak live bytes, and a histogram of the request sizes by power of
+  two. Not thread safe, one instance per thread.
+*/
+class allocation_stats {
+public:
+  static std::size_t const buckets = 48;
+
+private:
+  std::size_t m_allocations;
+  std::size_t m_deallocations;
+  std::size_t m_bytes;
+  std::size_t m_live;
+  std::size_t m_peak;
+  // m_histogram[i] counts the requests in [2^(i - 1), 2^i), 0 bytes in 0
+  std::size_t m_histogram[buckets];
+
+public:
+  allocation_stats();
+
+  // the stats of every allocator that was not given its own
+  static allocation_stats &global();
+
+  static std::size_t bucket(std::size_t bytes);
+
+  // counters and peak start over from now, live bytes stay
+  void reset();
+  void allocate(std::size_t bytes);
+  void deallocate(std::size_t bytes);
+
+  std::size_t allocations() const;
+  std::size_t deallocations() const;
+  std::size_t bytes() const;
+  std::size_t live() const;
+  std::size_t peak() const;
+  std::size_t histogram(std::size_t bucket) const;
+};
+
+/*
+  std::allocator with accounting, for the allocator parameter of any ft or
+  std container. Rebound copies, like the node allocator of Rb_tree, share
+  the stats of the allocator they come from.
+*/
+template <typename T> class tracking_allocator {
+  allocation_stats *m_stats;
+
+public:
+  typedef T value_type;
+  typedef T *pointer;
+  typedef T const *const_pointer;
+  typedef T &reference;
+  typedef T const &const_reference;
+  typedef std::size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+
+  template <typename U> struct rebind {
+    typedef tracking_allocator<U> other;
+  };
+
+  explicit tracking_allocator(
+      allocation_stats *stats = &allocation_stats::global())
+      : m_stats(stats) {}
+
+  template <typename U>
+  tracking_allocator(tracking_allocator<U> const &other)
+      : m_stats(other.stats()) {}
+
+  allocation_stats *stats() const { return m_stats; }
+
+  pointer address(reference x) const { return &x; }
+
+  const_pointer address(const_reference x) const { return &x; }
+
+  pointer allocate(size_type n, void const * = 0) {
+    if (n > max_size()) {
+      throw std::bad_alloc();
+    }
+    pointer p = static_cast<pointer>(::operator new(n * sizeof(T)));
+    m_stats->allocate(n * sizeof(T));
+    return p;
+  }
+
+  void deallocate(pointer p, size_type n) {
+    m_stats->deallocate(n * sizeof(T));
+    ::operator delete(p);
+  }
+
+  size_type max_size() const { return size_type(-1) / sizeof(T); }
+
+  void construct(pointer p, const_reference x) {
+    ::new (static_cast<void *>(p)) T(x);
+  }
+
+  void destroy(pointer p) { p->~T(); }
+};
+
+template <typename T, typename U>
+bool operator==(tracking_allocator<T> const &lhs,
+                tracking_allocator<U> const &rhs) {
+  return lhs.stats() == rhs.stats();
+}
+
+template <typename T, typename U>
+bool operator!=(tracking_allocator<T> const &lhs,
+                tracking_allocator<U> const &rhs) {
+  return !(lhs == rhs);
+}
+
+/*
+  Same usage as Chrono, every stop reports the time and the heap traffic of
+  the operations since the previous one, divided by their count. footprint
+  reports the memory held per element by what was built since begin: the
+  bytes asked to the tracking allocator, node headers and padding included,
+  and the growth of the resident set, which adds the malloc overhead.
+*/
+class Allocations {
+  struct rec {
+    std::string name;
+    std::size_t ops;
+    double time;
+    std::size_t allocations;
+    std::size_t deallocations;
+    std::size_t bytes;
+    std::size_t peak;
+  };
+  struct footprint_rec {
+    std::string name;
+    std::size_t elements;
+    std::size_t payload;
+    std::size_t live;
+    long resident;
+  };
+  std::string m_name;
+  allocation_stats *m_stats;
+  struct timespec m_start;
+  std::vector<rec> m_records;
+  std::vector<footprint_rec> m_footprints;
+  std::size_t m_histogram[allocation_stats::buckets];
+  std::size_t m_live_start;
+  long m_resident_start;
+
+public:
+  Allocations(std::string const &name,
+              allocation_stats *stats = &allocation_stats::global());
+
+  ~Allocations();
+
+  void begin();
+  void stop(std::string const &name, std::size_t ops);
+  // elements of payload bytes each are alive since begin
+  void footprint(std::string const &name, std::size_t elements,
+                 std::size_t payload);
+  void print() const;
+};
+
+#endif
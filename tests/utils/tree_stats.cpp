@@ -0,0 +1,45 @@
+#include "tree_stats.hpp"
+
+#include <iostream>
+
+TreeStats::TreeStats(std::string const &name)
+    : m_name(name), m_start(ft::Rb_tree_global_counters()) {}
+
+void TreeStats::begin() { m_start = ft::Rb_tree_global_counters(); }
+
+void TreeStats::stop(std::string const &name, std::size_t ops,
+                     ft::Rb_tree_stats const &shape) {
+  ft::Rb_tree_counters const &now = ft::Rb_tree_global_counters();
+  rec r;
+  r.name = name;
+  r.ops = ops ? ops : 1;
+  r.shape = shape;
+  r.rebalances = now.insert_rebalances + now.erase_rebalances -
+                 m_start.insert_rebalances - m_start.erase_rebalances;
+  r.rotations = now.rotations - m_start.rotations;
+  m_records.push_back(r);
+  begin();
+}
+
+void TreeStats::print() const {
+  std::cout << "[TREE] " << m_name << std::endl;
+  for (std::vector<rec>::const_iterator it = m_records.begin();
+       it != m_records.end(); ++it) {
+    ft::Rb_tree_stats const &s = it->shape;
+    // a find descends to a null link, then checks the candidate once more
+    std::cout << "  - " << it->name << " [" << s.size << "]: height "
+              << s.height << ", black height " << s.black_height
+              << ", depth " << s.average_depth << " avg, "
+              << s.average_search_depth + 1 << " cmp/lookup";
+    // inserts of a present key and erases of a missing one do not rebalance
+    if (ft::Rb_tree_counters_enabled()) {
+      std::cout << ", " << double(it->rotations) / it->ops << " rotations/op ("
+                << it->rebalances << " rebalances)";
+    }
+    std::cout << std::endl;
+  }
+  if (!ft::Rb_tree_counters_enabled()) {
+    std::cout << "  rotations: not counted, build with TREE_STATS=1"
+              << std::endl;
+  }
+}
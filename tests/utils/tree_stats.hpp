@@ -0,0 +1,37 @@
+#ifndef TREE_STATS_HPP
+#define TREE_STATS_HPP
+
+#include "../../ft/tree.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/*
+  Reports the shape of an ft tree after every step of a test and the
+  rebalancing work the step did. The work is only known when ft/tree.cpp is
+  built with FT_TREE_STATS (make TREE_STATS=1), the shape always is.
+*/
+class TreeStats {
+  struct rec {
+    std::string name;
+    std::size_t ops;
+    ft::Rb_tree_stats shape;
+    unsigned long rebalances;
+    unsigned long rotations;
+  };
+  std::string m_name;
+  ft::Rb_tree_counters m_start;
+  std::vector<rec> m_records;
+
+public:
+  TreeStats(std::string const &name);
+
+  void begin();
+  // ops operations were done on the tree of the given shape since begin
+  void stop(std::string const &name, std::size_t ops,
+            ft::Rb_tree_stats const &shape);
+  void print() const;
+};
+
+#endif
@@ -0,0 +1,102 @@
+#include "workload.hpp"
+#include <cmath>
+
+static double const g_zipfian_theta = 0.99;
+
+Workload::Workload(distribution d, std::size_t range, unsigned long long seed)
+    : m_distribution(d), m_range(range ? range : 1), m_state(seed),
+      m_index(0), m_teeth(std::size_t(std::sqrt(double(m_range)))), m_zeta(0),
+      m_alpha(0), m_eta(0) {
+  if (d != zipfian) {
+    return;
+  }
+  // Gray et al., "Quickly generating billion-record synthetic databases"
+  for (std::size_t i = 1; i <= m_range; ++i) {
+    m_zeta += 1 / std::pow(double(i), g_zipfian_theta);
+  }
+  double const zeta2 = 1 + 1 / std::pow(2.0, g_zipfian_theta);
+  m_alpha = 1 / (1 - g_zipfian_theta);
+  m_eta = (1 - std::pow(2.0 / m_range, 1 - g_zipfian_theta)) /
+          (1 - zeta2 / m_zeta);
+}
+
+char const *Workload::name(distribution d) {
+  static char const *const names[distribution_count] = {
+      "uniform", "zipfian", "sequential", "sawtooth", "adversarial"};
+  return names[d];
+}
+
+// splitmix64
+unsigned long long Workload::next_random() {
+  unsigned long long z = (m_state += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+// in [0, 1)
+double Workload::next_unit() {
+  return (next_random() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// rank in [0, range), 0 is the hottest
+std::size_t Workload::next_zipfian() {
+  double const u = next_unit();
+  double const uz = u * m_zeta;
+  if (uz < 1) {
+    return 0;
+  }
+  if (uz < 1 + std::pow(0.5, g_zipfian_theta)) {
+    return m_range > 1 ? 1 : 0;
+  }
+  std::size_t const rank =
+      std::size_t(m_range * std::pow(m_eta * u - m_eta + 1, m_alpha));
+  return rank < m_range ? rank : m_range - 1;
+}
+
+int Workload::next_key() {
+  std::size_t const i = m_index++;
+  switch (m_distribution) {
+  case uniform:
+    return int(next_random() % m_range);
+  case zipfian:
+    // a multiplicative hash scatters the ranks over the range
+    return int((next_zipfian() * 0x9e3779b97f4a7c15ULL >> 16) % m_range);
+  case sequential:
+    return int(i % m_range);
+  case sawtooth: {
+    // sqrt(range) runs of sqrt(range) keys
+    std::size_t const run = (m_range + m_teeth - 1) / m_teeth;
+    std::size_t const j = i % (m_teeth * run);
+    return int((j % run * m_teeth + j / run) % m_range);
+  }
+  case adversarial: {
+    std::size_t const j = i % m_range;
+    return int(j % 2 == 0 ? j / 2 : m_range - 1 - j / 2);
+  }
+  default:
+    return 0;
+  }
+}
+
+std::vector<int> Workload::keys(std::size_t n) {
+  std::vector<int> v;
+  v.reserve(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    v.push_back(next_key());
+  }
+  return v;
+}
+
+std::vector<Workload::operation> Workload::operations(std::size_t n,
+                                                      unsigned read_percent) {
+  std::vector<operation> v;
+  v.reserve(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    operation op;
+    op.read = next_random() % 100 < read_percent;
+    op.key = next_key();
+    v.push_back(op);
+  }
+  return v;
+}
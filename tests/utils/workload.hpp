@@ -0,0 +1,66 @@
+#ifndef WORKLOAD_HPP
+#define WORKLOAD_HPP
+
+#include <cstddef>
+#include <vector>
+
+/*
+  Key streams for the container benchmarks, all in [0, range) and
+  reproducible from their seed so both builds replay the same traffic.
+
+  - uniform: every key equally likely
+  - zipfian: a few hot keys take most of the traffic (theta 0.99, as YCSB),
+    the ranks are scattered over the range so hot keys are not neighbours
+  - sequential: 0, 1, 2, ... the best case for end hints
+  - sawtooth: ascending runs over the whole range, each one starting just
+    above where the previous one started
+  - adversarial: alternates between the two ends of the range closing in on
+    the middle, rebalancing on both spines and end hints wrong every other
+    time
+*/
+class Workload {
+public:
+  enum distribution {
+    uniform,
+    zipfian,
+    sequential,
+    sawtooth,
+    adversarial,
+    distribution_count
+  };
+
+  struct operation {
+    bool read; // a lookup, otherwise a write
+    int key;
+  };
+
+private:
+  distribution m_distribution;
+  std::size_t m_range;
+  unsigned long long m_state;
+  std::size_t m_index;
+  std::size_t m_teeth;
+  // zipfian constants
+  double m_zeta;
+  double m_alpha;
+  double m_eta;
+
+  unsigned long long next_random();
+  double next_unit();
+  std::size_t next_zipfian();
+
+public:
+  Workload(distribution d, std::size_t range, unsigned long long seed = 42);
+
+  static char const *name(distribution d);
+
+  int next_key();
+  std::vector<int> keys(std::size_t n);
+  /*
+    n operations, read_percent of them reads, the others writes. The keys
+    follow the distribution for both.
+  */
+  std::vector<operation> operations(std::size_t n, unsigned read_percent);
+};
+
+#endif
@@ -1,22 +1,104 @@
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
+#include <sstream>
 #include <stdexcept>
 #include <vector>
 
+#include "utils/bench.hpp"
 #include "utils/chrono.hpp"
 #include "utils/logger.hpp"
 #include "utils/testing_struct.hpp"
+#include "utils/threads.hpp"
+#include "utils/tracking_allocator.hpp"
 
 #ifdef STD
 #define VEC std::vector
 #define SWAP std::swap
+#define VEC_RESIZE_UNINITIALIZED(v, n) (v).resize(n)
 #else
 #include "../ft/vector.hpp"
 #define VEC ft::vector
 #define SWAP ft::swap
+#define VEC_RESIZE_UNINITIALIZED(v, n) (v).resize_uninitialized(n)
 #endif
 
+#ifdef STD
+template <typename V, typename A1>
+void vector_emplace_back(V &v, A1 const &a1) {
+  v.push_back(typename V::value_type(a1));
+}
+
+template <typename V, typename A1, typename A2, typename A3>
+void vector_emplace_back(V &v, A1 const &a1, A2 const &a2, A3 const &a3) {
+  v.push_back(typename V::value_type(a1, a2, a3));
+}
+
+template <typename V, typename A1>
+typename V::iterator vector_emplace(V &v, typename V::iterator pos,
+                                    A1 const &a1) {
+  return v.insert(pos, typename V::value_type(a1));
+}
+
+template <typename V> void vector_shrink_to_fit(V &v) { V(v).swap(v); }
+
+template <typename V>
+typename V::iterator vector_erase_unordered(V &v, typename V::iterator pos) {
+  typename V::difference_type const n = pos - v.begin();
+  *pos = v.back();
+  v.pop_back();
+  return v.begin() + n;
+}
+
+template <typename V, typename P>
+typename V::size_type vector_erase_if(V &v, P pred) {
+  typename V::iterator it = std::remove_if(v.begin(), v.end(), pred);
+  typename V::size_type const n = v.end() - it;
+  v.erase(it, v.end());
+  return n;
+}
+#else
+template <typename V, typename A1>
+void vector_emplace_back(V &v, A1 const &a1) {
+  v.emplace_back(a1);
+}
+
+template <typename V, typename A1, typename A2, typename A3>
+void vector_emplace_back(V &v, A1 const &a1, A2 const &a2, A3 const &a3) {
+  v.emplace_back(a1, a2, a3);
+}
+
+template <typename V, typename A1>
+typename V::iterator vector_emplace(V &v, typename V::iterator pos,
+                                    A1 const &a1) {
+  return v.emplace(pos, a1);
+}
+
+template <typename V> void vector_shrink_to_fit(V &v) { v.shrink_to_fit(); }
+
+template <typename V>
+typename V::iterator vector_erase_unordered(V &v, typename V::iterator pos) {
+  return v.erase_unordered(pos);
+}
+
+template <typename V, typename P>
+typename V::size_type vector_erase_if(V &v, P pred) {
+  return ft::erase_if(v, pred);
+}
+#endif
+
+template <typename T> struct vector_less_than {
+  T value;
+
+  vector_less_than(T const &v) : value(v) {}
+
+  bool operator()(T const &x) const { return x < value; }
+};
+
 #define VECTOR_PERF_BASE_SIZE 1000000 // 1 000 000
+#define VECTOR_THREADS_OPS 1000000    // per thread
+#define VECTOR_THREADS_MAX 8
+#define VECTOR_TRAVERSAL_WIDTH 64
 
 #define VECTOR_PRINT_STATE(vec) vector_print_state(vec, #vec)
 template <typename T>
@@ -63,6 +145,8 @@ template <typename T> void vector_impl_test(std::string const &type_name) {
 
   fill_constructor = copy_constructor;
   vector_print_state(fill_constructor, "assign operator");
+  // the state above is printed from a copy, this is the assigned storage
+  print_data(fill_constructor.capacity());
 
   print_data(*range_constructor.begin());
   print_data(*const_range_constructor.begin());
@@ -116,8 +200,20 @@ template <typename T> void vector_impl_test(std::string const &type_name) {
   default_constructor.resize(100);
   vector_print_state(default_constructor, "resize");
 
+  VEC_RESIZE_UNINITIALIZED(default_constructor, 200);
+  std::fill(default_constructor.begin() + 100, default_constructor.end(), 1);
+  vector_print_state(default_constructor, "resize uninitialized");
+
+  VEC_RESIZE_UNINITIALIZED(default_constructor, 100);
+  vector_print_state(default_constructor, "resize uninitialized decrease");
+
   default_constructor.reserve(999);
   vector_print_state(default_constructor, "reserve");
+  print_data(default_constructor.capacity());
+
+  vector_shrink_to_fit(default_constructor);
+  vector_print_state(default_constructor, "shrink to fit");
+  print_data(default_constructor.capacity());
 
   fill_constructor.assign(5, 0);
   vector_print_state(default_constructor, "assign fill");
@@ -141,9 +237,33 @@ template <typename T> void vector_impl_test(std::string const &type_name) {
                            copy_constructor.end());
   vector_print_state(range_constructor, "insert range");
 
+  vector_emplace_back(range_constructor, 42);
+  vector_print_state(range_constructor, "emplace back");
+
+  VEC<T> full(range_constructor);
+  vector_emplace_back(full, full.front());
+  vector_print_state(full, "emplace back self reference");
+
+  print_data(*vector_emplace(range_constructor, range_constructor.begin() + 2,
+                             43));
+  vector_print_state(range_constructor, "emplace");
+
+  print_data(*vector_emplace(range_constructor, range_constructor.end(), 44));
+  vector_print_state(range_constructor, "emplace end");
+
   range_constructor.erase(range_constructor.begin());
   vector_print_state(range_constructor, "erase");
 
+  print_data(*vector_erase_unordered(range_constructor,
+                                     range_constructor.begin() + 3));
+  vector_print_state(range_constructor, "erase unordered");
+
+  vector_erase_unordered(range_constructor, range_constructor.end() - 1);
+  vector_print_state(range_constructor, "erase unordered last");
+
+  print_data(vector_erase_if(range_constructor, vector_less_than<T>(T(5))));
+  vector_print_state(range_constructor, "erase if");
+
   range_constructor.clear();
   vector_print_state(range_constructor, "clear");
 
@@ -212,6 +332,22 @@ template <typename T> void vector_perf_test(std::string const &type_name) {
   v1.resize(VECTOR_PERF_BASE_SIZE / 100);
   chrono.stop("resize decrease");
 
+  vector_shrink_to_fit(v1);
+  chrono.stop("shrink to fit");
+
+  VEC<T> buffer;
+  for (int i = 0; i < 10; ++i) {
+    buffer.clear();
+    buffer.resize(VECTOR_PERF_BASE_SIZE);
+  }
+  chrono.stop("buffer refill resize");
+
+  for (int i = 0; i < 10; ++i) {
+    buffer.clear();
+    VEC_RESIZE_UNINITIALIZED(buffer, VECTOR_PERF_BASE_SIZE);
+  }
+  chrono.stop("buffer refill resize uninitialized");
+
   middle = v1.begin() + (v1.size() / 2);
   v1.erase(middle);
   chrono.stop("erase middle");
@@ -220,6 +356,40 @@ template <typename T> void vector_perf_test(std::string const &type_name) {
   v1.erase(middle, v1.end());
   chrono.stop("erase 2nd half");
 
+  VEC<T> v3(VECTOR_PERF_BASE_SIZE / 10);
+  VEC<T> v4(v3);
+  chrono.stop("erase setup");
+
+  for (int i = 0; i < 1000; ++i) {
+    v3.erase(v3.begin() + v3.size() / 2);
+  }
+  chrono.stop("repeated erase middle");
+
+  for (int i = 0; i < 1000; ++i) {
+    vector_erase_unordered(v4, v4.begin() + v4.size() / 2);
+  }
+  chrono.stop("repeated erase unordered middle");
+
+  VEC<T> v5;
+  for (int i = 0; i < VECTOR_PERF_BASE_SIZE / 100; ++i) {
+    v5.push_back(i % 2);
+  }
+  VEC<T> v6(v5);
+  vector_less_than<T> const is_even(T(1));
+  chrono.stop("erase if setup");
+
+  for (typename VEC<T>::iterator it = v5.begin(); it != v5.end();) {
+    if (is_even(*it)) {
+      it = v5.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  chrono.stop("repeated erase half");
+
+  vector_erase_if(v6, is_even);
+  chrono.stop("erase if half");
+
   v1.clear();
   chrono.stop("clear one");
 
@@ -229,6 +399,335 @@ template <typename T> void vector_perf_test(std::string const &type_name) {
   chrono.print();
 }
 
+// reads at indexes cycling through a shuffled permutation
+template <typename V> struct vector_random_access_case : bench_case {
+  V const &v;
+  std::vector<std::size_t> const &indexes;
+  std::size_t next;
+
+  vector_random_access_case(V const &v,
+                            std::vector<std::size_t> const &indexes)
+      : v(v), indexes(indexes), next(0) {}
+
+  void operator()(std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      do_not_optimize(v[indexes[next]]);
+      if (++next == indexes.size()) {
+        next = 0;
+      }
+    }
+  }
+};
+
+// one increment per operation, wrapping around at the end
+template <typename V> struct vector_iterate_case : bench_case {
+  V const &v;
+  typename V::const_iterator it;
+
+  vector_iterate_case(V const &v) : v(v), it(v.begin()) {}
+
+  void operator()(std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      do_not_optimize(*it);
+      if (++it == v.end()) {
+        it = v.begin();
+      }
+    }
+  }
+};
+
+// shifts the second half twice per operation, the size stays constant
+template <typename V> struct vector_insert_erase_middle_case : bench_case {
+  V &v;
+  typename V::value_type value;
+
+  vector_insert_erase_middle_case(V &v, typename V::value_type const &value)
+      : v(v), value(value) {}
+
+  void operator()(std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      v.insert(v.begin() + v.size() / 2, value);
+      v.erase(v.begin() + v.size() / 2);
+    }
+  }
+};
+
+// random reads on one vector against a copy per thread
+template <typename T>
+void vector_threads_perf_test(std::string const &type_name) {
+  std::vector<std::size_t> indexes;
+  for (std::size_t i = 0; i < VECTOR_PERF_BASE_SIZE; ++i) {
+    indexes.push_back(i);
+  }
+  std::vector<VEC<T> > vectors(1, VEC<T>(indexes.begin(), indexes.end()));
+
+  Threads threads("vector", type_name);
+  for (std::size_t n = 1; n <= VECTOR_THREADS_MAX; n *= 2) {
+    std::vector<std::vector<std::size_t> > orders(n, indexes);
+    for (std::size_t t = 0; t < n; ++t) {
+      std::random_shuffle(orders[t].begin(), orders[t].end());
+    }
+    vectors.resize(n, vectors[0]);
+
+    for (int shared = 1; shared >= 0; --shared) {
+      std::vector<vector_random_access_case<VEC<T> > *> cases;
+      for (std::size_t t = 0; t < n; ++t) {
+        cases.push_back(new vector_random_access_case<VEC<T> >(
+            vectors[shared ? 0 : t], orders[t]));
+      }
+      threads.run(shared ? "random access shared"
+                         : "random access per thread",
+                  cases, VECTOR_THREADS_OPS);
+      for (std::size_t t = 0; t < n; ++t) {
+        delete cases[t];
+      }
+    }
+  }
+  threads.print();
+}
+
+// one decrement per operation, wrapping around at the beginning
+template <typename V> struct vector_reverse_iterate_case : bench_case {
+  V const &v;
+  typename V::const_iterator it;
+
+  vector_reverse_iterate_case(V const &v) : v(v), it(v.end()) {}
+
+  void operator()(std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      if (it == v.begin()) {
+        it = v.end();
+      }
+      --it;
+      do_not_optimize(*it);
+    }
+  }
+};
+
+/*
+  One lower_bound..upper_bound scan of the sorted vector per operation, over
+  [lows[i], highs[i]]. The flat counterpart of the map and set range scans.
+*/
+template <typename V> struct vector_range_scan_case : bench_case {
+  V const &v;
+  std::vector<typename V::value_type> const &lows;
+  std::vector<typename V::value_type> const &highs;
+  std::size_t next;
+
+  vector_range_scan_case(V const &v,
+                         std::vector<typename V::value_type> const &lows,
+                         std::vector<typename V::value_type> const &highs)
+      : v(v), lows(lows), highs(highs), next(0) {}
+
+  void operator()(std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      typename V::const_iterator it =
+          std::lower_bound(v.begin(), v.end(), lows[next]);
+      typename V::const_iterator const last =
+          std::upper_bound(it, v.end(), highs[next]);
+      for (; it != last; ++it) {
+        do_not_optimize(*it);
+      }
+      if (++next == lows.size()) {
+        next = 0;
+      }
+    }
+  }
+};
+
+// traversals of a sorted vector, same cases as the map and set ones
+template <typename T>
+void vector_traversal_perf_test(std::string const &type_name) {
+  Bench bench("vector", type_name + " sorted");
+  // from cache resident to far out, unless a sweep was asked for
+  std::vector<std::size_t> const sizes = Bench::sweep_sizes_or(10, 20, 5);
+
+  for (std::size_t i = 0; i < sizes.size(); ++i) {
+    std::vector<int> order;
+    VEC<T> v;
+    for (std::size_t k = 0; k < sizes[i]; ++k) {
+      order.push_back(int(k));
+      v.push_back(T(int(k)));
+    }
+    std::random_shuffle(order.begin(), order.end());
+    std::vector<T> lows;
+    std::vector<T> highs;
+    for (std::size_t k = 0; k < order.size(); ++k) {
+      lows.push_back(T(order[k]));
+      highs.push_back(T(order[k] + VECTOR_TRAVERSAL_WIDTH - 1));
+    }
+    bench.size(v.size());
+
+    vector_iterate_case<VEC<T> > forward(v);
+    bench.run("forward", forward);
+    vector_reverse_iterate_case<VEC<T> > reverse(v);
+    bench.run("reverse", reverse);
+    vector_range_scan_case<VEC<T> > range(v, lows, highs);
+    std::ostringstream label;
+    label << "range " << VECTOR_TRAVERSAL_WIDTH;
+    bench.run(label.str(), range);
+  }
+  bench.print_curves();
+}
+
+template <typename T>
+void vector_sweep_perf_test(std::string const &type_name) {
+  Bench bench("vector", type_name);
+  std::vector<std::size_t> const &sizes = Bench::sweep_sizes();
+
+  for (std::size_t i = 0; i < sizes.size(); ++i) {
+    VEC<T> v;
+    std::vector<std::size_t> indexes;
+    indexes.reserve(sizes[i]);
+    for (std::size_t k = 0; k < sizes[i]; ++k) {
+      v.push_back(T(int(k)));
+      indexes.push_back(k);
+    }
+    std::random_shuffle(indexes.begin(), indexes.end());
+    bench.size(v.size());
+
+    vector_random_access_case<VEC<T> > random_access(v, indexes);
+    bench.run("random access", random_access);
+    vector_iterate_case<VEC<T> > iterate(v);
+    bench.run("iterate", iterate);
+    vector_insert_erase_middle_case<VEC<T> > insert_erase(v, T(-1));
+    bench.run("insert erase middle", insert_erase);
+  }
+  bench.print_curves();
+}
+
+void vector_emplace_perf_test() {
+  Chrono chrono("testing_struct emplace");
+  std::string const s(64, 'x');
+  chrono.begin();
+
+  VEC<testing_struct> v1;
+  v1.reserve(VECTOR_PERF_BASE_SIZE);
+  for (int i = 0; i < VECTOR_PERF_BASE_SIZE; ++i) {
+    v1.push_back(testing_struct(i, 'c', s));
+  }
+  chrono.stop("push back temporary");
+
+  VEC<testing_struct> v2;
+  v2.reserve(VECTOR_PERF_BASE_SIZE);
+  for (int i = 0; i < VECTOR_PERF_BASE_SIZE; ++i) {
+    vector_emplace_back(v2, i, 'c', s);
+  }
+  chrono.stop("emplace back");
+
+  VEC<testing_struct> v3;
+  for (int i = 0; i < VECTOR_PERF_BASE_SIZE; ++i) {
+    vector_emplace_back(v3, i, 'c', s);
+  }
+  chrono.stop("emplace back with reallocation");
+
+  chrono.print();
+}
+
+// counts differ between the builds, only the balance is printed
+void vector_allocator_impl_test() {
+  typedef VEC<testing_struct, tracking_allocator<testing_struct> > vector;
+
+  print_data("tracking allocator");
+  allocation_stats stats;
+  {
+    tracking_allocator<testing_struct> const alloc(&stats);
+    vector v(alloc);
+    for (int i = 0; i < 100; ++i) {
+      v.push_back(testing_struct(i));
+    }
+    vector copy(v);
+    copy.insert(copy.begin() + 50, v.begin(), v.end());
+    v.assign(10, testing_struct(1));
+    print_data(copy.get_allocator() == alloc);
+    print_data(stats.live() >=
+               (copy.size() + v.size()) * sizeof(testing_struct));
+    print_data(copy.size());
+  }
+  print_data(stats.allocations() == stats.deallocations());
+  print_data(stats.live());
+}
+
+/*
+  Same output in both builds; with AUTO_SHRINK=1 the ft build also checks that
+  erasing below a quarter of the capacity gives memory back.
+*/
+void vector_auto_shrink_impl_test() {
+  print_data("auto shrink");
+
+  VEC<int> v;
+  for (int i = 0; i < 1000; ++i) {
+    v.push_back(i);
+  }
+  std::size_t const full = v.capacity();
+  print_data(full >= v.size());
+  // erase never reallocates, the elements before the erased ones stay put
+  int const *const first = &v[0];
+  v.erase(v.begin() + 100, v.end());
+  print_data(v.size());
+  print_data(v.back());
+  print_data(&v[0] == first);
+  print_data(v.capacity() == full);
+
+  v.resize(50);
+  print_data(v.size());
+#if defined(FT_VECTOR_AUTO_SHRINK) && !defined(STD)
+  assert(v.capacity() < full);
+  assert(v.capacity() >= v.size());
+#endif
+
+  std::size_t const resized = v.capacity();
+  print_data(resized >= v.size());
+  while (v.size() > 10) {
+    v.pop_back();
+  }
+  print_data(v.size());
+  print_data(v.back());
+#if defined(FT_VECTOR_AUTO_SHRINK) && !defined(STD)
+  assert(v.capacity() < resized);
+  assert(v.capacity() <= 4 * v.size());
+#endif
+}
+
+template <typename T>
+void vector_allocation_perf_test(std::string const &type_name) {
+  typedef VEC<T, tracking_allocator<T> > vector;
+  std::size_t const n = VECTOR_PERF_BASE_SIZE;
+
+  Allocations allocations("vector " + type_name);
+  allocations.begin();
+  {
+    vector v;
+    for (std::size_t i = 0; i < n; ++i) {
+      v.push_back(T(i));
+    }
+    allocations.stop("push back", n);
+    allocations.footprint("push back", v.size(), sizeof(T));
+
+    vector reserved;
+    reserved.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      reserved.push_back(T(i));
+    }
+    allocations.stop("reserve push back", n);
+
+    vector copy(v);
+    allocations.stop("copy constructor", n);
+
+    v.insert(v.begin() + n / 2, copy.begin(), copy.begin() + n / 10);
+    allocations.stop("range insert", n / 10);
+
+    std::size_t const added = n * 2 - v.size();
+    v.resize(n * 2);
+    allocations.stop("resize increase", added);
+
+    v.clear();
+    allocations.stop("clear", n);
+  }
+  allocations.stop("destruction", 3);
+  allocations.print();
+}
+
 void tests_vector_impl() {
   print_header("vector impl");
 
@@ -238,6 +737,8 @@ void tests_vector_impl() {
   vector_impl_test<int>("int");
   vector_impl_test<char>("float");
   vector_impl_test<testing_struct>("testing_struct");
+  vector_allocator_impl_test();
+  vector_auto_shrink_impl_test();
 
   chrono.stop("total impl");
   chrono.print();
@@ -249,8 +750,26 @@ void tests_vector_perf() {
   Chrono chrono("vector perf");
   chrono.begin();
 
+  if (!Bench::sweep_sizes().empty()) {
+    vector_sweep_perf_test<int>("int");
+    vector_sweep_perf_test<testing_struct>("testing_struct");
+    vector_traversal_perf_test<int>("int");
+    chrono.stop("total sweep");
+    chrono.print();
+    return;
+  }
+
   vector_perf_test<int>("int");
   vector_perf_test<testing_struct>("testing_struct");
+  vector_emplace_perf_test();
+  chrono.stop("setup allocations");
+  vector_allocation_perf_test<int>("int");
+  vector_allocation_perf_test<testing_struct>("testing_struct");
+  chrono.stop("allocations");
+  vector_threads_perf_test<int>("int");
+  chrono.stop("threads");
+  vector_traversal_perf_test<int>("int");
+  chrono.stop("traversal");
 
   chrono.stop("total perf");
   chrono.print();